@@ -0,0 +1,469 @@
+#include "BranchAndBound.hpp"
+#include "LocalSearch.hpp"
+#include "Parallel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <queue>
+
+namespace {
+  // Edge states within a subproblem
+  constexpr int8_t FREE = 0;
+  constexpr int8_t FORCED = 1;
+  constexpr int8_t FORBIDDEN = -1;
+
+  // Weight offset that keeps forced edges in, & forbidden edges out of, every 1-tree
+  constexpr double BIG = 1e9;
+
+  // Subgradient schedule for non-root subproblems, which start from their parent's penalties
+  constexpr size_t CHILD_PERIOD = 16;
+  constexpr double MIN_STEP = 1e-3;
+
+  // How often the search reports its progress when nothing else changes
+  constexpr auto REPORT_INTERVAL = std::chrono::milliseconds(500);
+
+  struct Constraint {
+    uint32_t i, j;
+    int8_t state;
+  };
+
+  /**
+   * A subproblem: the edge constraints accumulated along its branch, the node penalties it inherits,
+   * & the bound of its parent (a valid lower bound until the subproblem itself is evaluated).
+   */
+  struct Subproblem {
+    double bound;
+    std::vector<Constraint> constraints;
+    std::vector<double> pi;
+  };
+
+  struct WorseBound {
+    bool operator()(const Subproblem& a, const Subproblem& b) const { return a.bound > b.bound; }
+  };
+
+  // A worker's best-first queue; the bounds are published separately so progress reports never wait on a queue
+  struct Worker {
+    std::mutex lock;
+    std::priority_queue<Subproblem, std::vector<Subproblem>, WorseBound> queue;
+    std::atomic<double> queue_floor{std::numeric_limits<double>::infinity()};
+    std::atomic<double> active{std::numeric_limits<double>::infinity()};
+
+    // Call while holding `lock`
+    void refloor() {
+      queue_floor = queue.empty() ? std::numeric_limits<double>::infinity() : queue.top().bound;
+    }
+  };
+
+  // The result of evaluating a subproblem's 1-tree
+  struct OneTree {
+    double length;
+    std::vector<uint32_t> parent;  // parent[v] in the spanning tree over 1..n-1, parent[1] unused
+    uint32_t first, second;        // the two edges of city 0
+    std::vector<uint32_t> degree;
+  };
+
+  class Search {
+  public:
+    Search(const std::vector<Node>& cities_, const size_t& threads_,
+           const std::function<void(const TSP::BranchAndBoundReport&)>& report_)
+      : cities{cities_}, n{cities_.size()}, dist{TSP::distanceMatrix(cities_)},
+        workers(threads_), report{report_} {}
+
+    std::vector<size_t> run(const std::vector<size_t>& initial, const size_t& initial_length);
+
+  private:
+    const std::vector<Node>& cities;
+    const size_t n;
+    const std::vector<uint32_t> dist;
+    std::vector<Worker> workers;
+    std::function<void(const TSP::BranchAndBoundReport&)> report;
+
+    std::mutex best_lock;
+    std::vector<size_t> best_order;
+    std::atomic<size_t> upper{0};
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> explored{0};
+    std::mutex idle_lock;
+    std::condition_variable idle;
+    std::mutex report_lock;
+    std::chrono::steady_clock::time_point last_report;
+
+    void work(const size_t& self);
+    void wake();
+    bool take(const size_t& self, Subproblem& out);
+    void evaluate(Subproblem& sub, std::vector<int8_t>& state, std::vector<std::vector<Subproblem>>& children,
+                  const bool& root);
+    OneTree oneTree(const std::vector<int8_t>& state, const std::vector<double>& pi) const;
+    void offerTour(const OneTree& tree);
+    void publish(const bool& force);
+  };
+
+  /**
+   * Computes the minimum 1-tree under penalized weights c_ij + pi_i + pi_j with Prim's algorithm on the
+   * dense matrix: a spanning tree over cities 1..n-1 plus the two cheapest edges of city 0.
+   */
+  OneTree Search::oneTree(const std::vector<int8_t>& state, const std::vector<double>& pi) const {
+    auto weight = [&](const size_t& i, const size_t& j) {
+      double w = dist[i * n + j] + pi[i] + pi[j];
+      const int8_t s = state[i * n + j];
+      return s == FORCED ? w - BIG : (s == FORBIDDEN ? w + BIG : w);
+    };
+
+    OneTree tree;
+    tree.parent.assign(n, 1);
+    tree.degree.assign(n, 0);
+    tree.length = 0;
+
+    std::vector<double> key(n, std::numeric_limits<double>::infinity());
+    std::vector<bool> in_tree(n, false);
+    key[1] = 0;
+    for (size_t step = 1; step < n; step++) {
+      size_t v = 0;
+      double best = std::numeric_limits<double>::infinity();
+      for (size_t u = 1; u < n; u++) {
+        if (!in_tree[u] && key[u] < best) { best = key[u]; v = u; }
+      }
+      in_tree[v] = true;
+      if (v != 1) {
+        tree.length += best;
+        tree.degree[v]++;
+        tree.degree[tree.parent[v]]++;
+      }
+      for (size_t u = 1; u < n; u++) {
+        if (in_tree[u]) continue;
+        double w = weight(v, u);
+        if (w < key[u]) { key[u] = w; tree.parent[u] = v; }
+      }
+    }
+
+    // Attach city 0 by its two cheapest edges
+    tree.first = tree.second = 1;
+    double first = std::numeric_limits<double>::infinity(), second = first;
+    for (size_t u = 1; u < n; u++) {
+      double w = weight(0, u);
+      if (w < first) { second = first; tree.second = tree.first; first = w; tree.first = u; }
+      else if (w < second) { second = w; tree.second = u; }
+    }
+    tree.length += first + second;
+    tree.degree[0] = 2;
+    tree.degree[tree.first]++;
+    tree.degree[tree.second]++;
+
+    for (size_t i = 0; i < n; i++) tree.length -= 2 * pi[i];
+    return tree;
+  }
+
+  /**
+   * Records the 1-tree as the incumbent if it is a Hamiltonian cycle shorter than the current upper bound.
+   */
+  void Search::offerTour(const OneTree& tree) {
+    std::vector<std::vector<uint32_t>> adj(n);
+    for (size_t v = 2; v < n; v++) {
+      adj[v].push_back(tree.parent[v]);
+      adj[tree.parent[v]].push_back(v);
+    }
+    adj[0] = {tree.first, tree.second};
+    adj[tree.first].push_back(0);
+    adj[tree.second].push_back(0);
+
+    std::vector<size_t> order;
+    order.reserve(n);
+    size_t prev = 0, current = 0;
+    size_t length = 0;
+    do {
+      order.push_back(current);
+      size_t next = adj[current][0] == prev && order.size() > 1 ? adj[current][1] : adj[current][0];
+      length += dist[current * n + next];
+      prev = current;
+      current = next;
+    } while (current != 0 && order.size() <= n);
+    if (order.size() != n) return;
+
+    std::lock_guard<std::mutex> guard(best_lock);
+    if (length < upper.load()) {
+      upper = length;
+      best_order = order;
+      publish(true);
+    }
+  }
+
+  /**
+   * Tightens a subproblem's bound by subgradient optimization, then prunes it, records it as a tour, or
+   * branches on a city of degree > 2 (Volgenant & Jonker): exclude e1; include e1 & exclude e2; include both.
+   */
+  void Search::evaluate(Subproblem& sub, std::vector<int8_t>& state,
+                        std::vector<std::vector<Subproblem>>& children, const bool& root) {
+    for (const Constraint& c : sub.constraints) state[c.i * n + c.j] = state[c.j * n + c.i] = c.state;
+
+    // A city with two forced edges cannot use any other edge
+    std::vector<uint32_t> forced(n, 0), allowed(n, n - 1);
+    for (const Constraint& c : sub.constraints) {
+      if (c.state == FORCED) { forced[c.i]++; forced[c.j]++; }
+      else { allowed[c.i]--; allowed[c.j]--; }
+    }
+    bool feasible = true;
+    for (size_t v = 0; v < n; v++) feasible = feasible && forced[v] <= 2 && allowed[v] >= 2;
+    std::vector<Constraint> saturated;
+    for (size_t v = 0; feasible && v < n; v++) {
+      if (forced[v] != 2) continue;
+      for (size_t u = 0; u < n; u++) {
+        if (u != v && state[v * n + u] == FREE) {
+          state[v * n + u] = state[u * n + v] = FORBIDDEN;
+          saturated.push_back({uint32_t(v), uint32_t(u), FORBIDDEN});
+        }
+      }
+    }
+
+    size_t forced_edges = 0;
+    for (const Constraint& c : sub.constraints) forced_edges += c.state == FORCED;
+
+    // Subgradient ascent on the penalties (the schedule of Helsgaun's LKH): the step doubles while the bound
+    // improves during the initial phase, then step & period halve each round until either runs out
+    std::vector<double> pi = sub.pi, best_pi = sub.pi;
+    OneTree tree = oneTree(state, pi), best_tree = tree;
+    double best_bound = tree.length + BIG * forced_edges;
+    // The tree dropped a forced edge or used a forbidden one: no tour satisfies the constraints
+    auto violated = [](const double& bound) { return bound > BIG / 2; };
+    feasible = feasible && !violated(best_bound);
+
+    std::vector<double> last_v(n);
+    for (size_t v = 0; v < n; v++) last_v[v] = tree.degree[v] - 2.0;
+    size_t period = root ? std::max<size_t>(n / 2, 100) : CHILD_PERIOD;
+    bool initial_phase = root;
+    double step = 1.0;
+    bool done = !feasible;
+    while (!done && period > 0 && step > MIN_STEP) {
+      for (size_t p = 1; !done && p <= period; p++) {
+        double norm = 0;
+        for (size_t v = 0; v < n; v++) norm += (tree.degree[v] - 2.0) * (tree.degree[v] - 2.0);
+        if (norm == 0) break;
+        for (size_t v = 0; v < n; v++) {
+          const double deviation = tree.degree[v] - 2.0;
+          pi[v] += step * (0.7 * deviation + 0.3 * last_v[v]);
+          last_v[v] = deviation;
+        }
+
+        tree = oneTree(state, pi);
+        const double bound = tree.length + BIG * forced_edges;
+        if (violated(bound)) { feasible = false; break; }
+        if (bound > best_bound + 1e-9) {
+          best_bound = bound;
+          best_tree = tree;
+          best_pi = pi;
+          if (initial_phase) step *= 2;
+          if (root && p == period) period *= 2;
+        } else if (initial_phase && p > period / 2) {
+          initial_phase = false;
+          p = 0;
+          step = 3 * step / 4;
+        }
+        done = std::ceil(best_bound - 1e-6) >= upper.load();
+      }
+      period /= 2;
+      step /= 2;
+    }
+
+    for (const Constraint& c : sub.constraints) state[c.i * n + c.j] = state[c.j * n + c.i] = FREE;
+    for (const Constraint& c : saturated) state[c.i * n + c.j] = state[c.j * n + c.i] = FREE;
+    if (!feasible || std::ceil(best_bound - 1e-6) >= upper.load()) return;
+
+    // Pick the city with the highest 1-tree degree
+    size_t branch = 0;
+    for (size_t v = 1; v < n; v++) if (best_tree.degree[v] > best_tree.degree[branch]) branch = v;
+    if (best_tree.degree[branch] <= 2) { offerTour(best_tree); return; }
+
+    // Its free tree edges, in order of increasing penalized weight
+    std::vector<uint32_t> free_edges;
+    auto adjacent = [&](const size_t& u) {
+      if (branch == 0) return u == best_tree.first || u == best_tree.second;
+      if (u == 0) return branch == best_tree.first || branch == best_tree.second;
+      return (u >= 2 && best_tree.parent[u] == branch) || (branch >= 2 && best_tree.parent[branch] == u);
+    };
+    for (size_t u = 0; u < n; u++) {
+      if (u == branch || !adjacent(u)) continue;
+      bool constrained = false;
+      for (const Constraint& c : sub.constraints) {
+        constrained = constrained || (c.i == branch && c.j == u) || (c.i == u && c.j == branch);
+      }
+      if (!constrained) free_edges.push_back(u);
+    }
+    if (free_edges.empty()) return;
+    std::sort(free_edges.begin(), free_edges.end(), [&](const uint32_t& a, const uint32_t& b) {
+      return dist[branch * n + a] + best_pi[a] < dist[branch * n + b] + best_pi[b];
+    });
+
+    const double bound = std::ceil(best_bound - 1e-6);
+    auto child = [&](std::initializer_list<Constraint> extra) {
+      Subproblem next{bound, sub.constraints, best_pi};
+      next.constraints.insert(next.constraints.end(), extra);
+      return next;
+    };
+    const uint32_t v = branch, e1 = free_edges[0];
+    std::vector<Subproblem> made;
+    made.push_back(child({{v, e1, FORBIDDEN}}));
+    if (forced[v] == 1 || free_edges.size() < 2) {
+      made.push_back(child({{v, e1, FORCED}}));
+    } else {
+      const uint32_t e2 = free_edges[1];
+      made.push_back(child({{v, e1, FORCED}, {v, e2, FORBIDDEN}}));
+      made.push_back(child({{v, e1, FORCED}, {v, e2, FORCED}}));
+    }
+    children.push_back(std::move(made));
+  }
+
+  /**
+   * Pops the best subproblem from the worker's own queue, or steals the best one from another worker.
+   */
+  bool Search::take(const size_t& self, Subproblem& out) {
+    for (size_t k = 0; k < workers.size(); k++) {
+      Worker& victim = workers[(self + k) % workers.size()];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (victim.queue.empty()) continue;
+      out = victim.queue.top();
+      victim.queue.pop();
+      queued--;
+      workers[self].active = out.bound;
+      victim.refloor();
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Wakes the workers parked in `work`. Taking the lock orders the wake-up after a waiter's check of
+   * `queued` & `pending`, so one that has just found nothing to take cannot miss it.
+   */
+  void Search::wake() {
+    std::lock_guard<std::mutex> guard(idle_lock);
+    idle.notify_all();
+  }
+
+  /**
+   * Evaluates subproblems until every queue is empty & no worker holds a subproblem. A worker that finds
+   * nothing to take parks until another pushes children or the last pending subproblem is done, rather than
+   * spinning on the pool thread it holds.
+   */
+  void Search::work(const size_t& self) {
+    std::vector<int8_t> state(n * n, FREE);
+    Subproblem sub;
+    while (pending.load() > 0) {
+      if (!take(self, sub)) {
+        std::unique_lock<std::mutex> guard(idle_lock);
+        idle.wait(guard, [&]() { return queued.load() > 0 || pending.load() == 0; });
+        continue;
+      }
+
+      std::vector<std::vector<Subproblem>> children;
+      if (std::ceil(sub.bound - 1e-6) < upper.load()) evaluate(sub, state, children, false);
+      explored++;
+
+      bool pushed = false;
+      {
+        std::lock_guard<std::mutex> guard(workers[self].lock);
+        for (std::vector<Subproblem>& made : children) {
+          for (Subproblem& next : made) {
+            pending++;
+            queued++;
+            workers[self].queue.push(std::move(next));
+            pushed = true;
+          }
+        }
+        workers[self].refloor();
+      }
+      workers[self].active = std::numeric_limits<double>::infinity();
+      if (--pending == 0 || pushed) wake();
+      publish(false);
+    }
+  }
+
+  /**
+   * Reports the current bounds if forced or if the report interval has elapsed.
+   */
+  void Search::publish(const bool& force) {
+    if (!report) return;
+    std::unique_lock<std::mutex> guard(report_lock, std::defer_lock);
+    if (force) guard.lock();
+    else if (!guard.try_lock()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - last_report < REPORT_INTERVAL) return;
+    last_report = now;
+
+    TSP::BranchAndBoundReport snapshot{upper.load(), upper.load(), explored.load(), 0};
+    double lowest = std::numeric_limits<double>::infinity();
+    for (Worker& w : workers) lowest = std::min({lowest, w.active.load(), w.queue_floor.load()});
+    snapshot.open_nodes = pending.load();
+    if (lowest < snapshot.upper_bound) snapshot.lower_bound = size_t(std::max(0.0, std::ceil(lowest - 1e-6)));
+    report(snapshot);
+  }
+
+  std::vector<size_t> Search::run(const std::vector<size_t>& initial, const size_t& initial_length) {
+    best_order = initial;
+    upper = initial_length;
+    last_report = std::chrono::steady_clock::now();
+
+    // Root: many subgradient iterations to find good penalties that all descendants inherit
+    std::vector<int8_t> state(n * n, FREE);
+    Subproblem root{0, {}, std::vector<double>(n, 0.0)};
+    std::vector<std::vector<Subproblem>> children;
+    evaluate(root, state, children, true);
+    explored++;
+    for (std::vector<Subproblem>& made : children) {
+      for (Subproblem& next : made) {
+        pending++;
+        queued++;
+        workers[0].queue.push(std::move(next));
+      }
+    }
+    workers[0].refloor();
+    publish(true);
+
+    // Workers that find every queue empty return as soon as nothing is pending, so pool threads may run them in turn
+    Parallel::parallelFor(0, workers.size(), [&](size_t t) { work(t); }, workers.size(), 1);
+
+    publish(true);
+    return best_order;
+  }
+}
+
+/**
+ * The relative optimality gap (upper_bound - lower_bound) / upper_bound; 0 once the tour is proven optimal.
+ */
+double TSP::BranchAndBoundReport::gap() const {
+  if (upper_bound == 0 || lower_bound >= upper_bound) return 0.0;
+  return double(upper_bound - lower_bound) / upper_bound;
+}
+
+/**
+ * Constructs a provably optimal tour using branch-and-bound over Held-Karp 1-tree bounds.
+ *
+ * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+ * @param threads The number of worker threads exploring subproblems.
+ * @param report Called whenever the upper bound improves, periodically while the search runs, and once at the end.
+ * @return A `TSP::Tour` object representing an optimal path, its edge weights, and its total distance.
+ */
+TSP::Tour TSP::branchAndBound(const std::vector<Node>& cities, const size_t& threads,
+                              const std::function<void(const TSP::BranchAndBoundReport&)>& report) {
+  if (cities.size() < 4) return makeTour(cities);
+
+  // Initial upper bound from the nearest neighbor tour, polished by 2-opt
+  Tour initial = twoOpt(nearestNeighbor(std::list<Node>(cities.begin(), cities.end()), cities.front().id));
+  const CitySet set(cities);
+  std::vector<size_t> initial_order;
+  for (size_t i = 0; i + 1 < initial.path.size(); i++) initial_order.push_back(set.index(initial.path[i].id));
+
+  Search search(cities, std::max<size_t>(1, threads), report);
+  std::vector<size_t> order = search.run(initial_order, initial.total_distance);
+
+  // Rotate so the tour starts at cities.front()
+  std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+  std::vector<Node> path;
+  path.reserve(order.size());
+  for (const size_t& i : order) path.push_back(cities[i]);
+  return makeTour(path);
+}
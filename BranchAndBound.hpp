@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "Node.hpp"
+#include "Parallel.hpp"
+#include "TSP.hpp"
+
+namespace TSP {
+  /**
+   * A snapshot of branch-and-bound progress.
+   *
+   * @details
+   * - `upper_bound` is the length of the best tour found so far.
+   * - `lower_bound` is the smallest 1-tree bound among the subproblems still open; no tour can be shorter.
+   * - `nodes_explored` counts subproblems whose bound has been evaluated.
+   * - `open_nodes` counts subproblems that are queued or being evaluated.
+   */
+  struct BranchAndBoundReport {
+    size_t upper_bound;
+    size_t lower_bound;
+    size_t nodes_explored;
+    size_t open_nodes;
+
+    /**
+     * The relative optimality gap (upper_bound - lower_bound) / upper_bound; 0 once the tour is proven optimal.
+     */
+    double gap() const;
+  };
+
+  /**
+   * Constructs a provably optimal tour using branch-and-bound over Held-Karp 1-tree bounds.
+   *
+   * @details
+   * The initial upper bound comes from `nearestNeighbor` followed by `twoOpt`. Each subproblem's bound is the
+   * 1-tree length after subgradient optimization of the node penalties, and subproblems are branched on the
+   * edges of a node whose 1-tree degree exceeds 2. Every worker keeps its own best-first queue and steals the
+   * best subproblem of another worker when its queue runs dry.
+   *
+   * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+   * @param threads The number of worker threads exploring subproblems.
+   * @param report Called whenever the upper bound improves, periodically while the search runs, and once at the end.
+   * @return A `TSP::Tour` object representing an optimal path, its edge weights, and its total distance.
+   *
+   * @note Intended for instances of up to a few hundred cities; memory & time grow with n^2 per subproblem.
+   */
+  Tour branchAndBound(const std::vector<Node>& cities,
+                      const size_t& threads = Parallel::defaultThreads(),
+                      const std::function<void(const BranchAndBoundReport&)>& report = nullptr);
+};
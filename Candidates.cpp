@@ -0,0 +1,412 @@
+#include "Candidates.hpp"
+#include "Popmusic.hpp"
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+/**
+ * Builds K-nearest candidate lists for every city using a spatial grid, in parallel across cities.
+ *
+ * @param cities The cities to connect.
+ * @param k The number of candidates per city.
+ * @param threads The number of threads building lists.
+ * @return The candidate lists, each ordered by increasing distance.
+ */
+TSP::Candidates TSP::nearestCandidates(const CitySet& cities, const size_t& k, const size_t& threads) {
+  return buildCandidates(cities, k, CandidateRule::NEAREST, threads);
+}
+
+/**
+ * Builds candidate lists for every city using a spatial grid, in parallel across cities.
+ *
+ * @param cities The cities to connect.
+ * @param k The number of candidates per city.
+ * @param rule How the candidates are chosen.
+ * @param threads The number of threads building lists.
+ * @return The candidate lists, each ordered by increasing distance (by increasing alpha for `ALPHA`).
+ */
+TSP::Candidates TSP::buildCandidates(const CitySet& cities, const size_t& k, const CandidateRule& rule,
+                                     const size_t& threads) {
+  if (rule == CandidateRule::ALPHA) return alphaCandidates(cities, k, 0, threads);
+  if (rule == CandidateRule::POPMUSIC) return popmusicCandidates(cities, k, 5, 50, threads);
+  const size_t n = cities.size();
+  Candidates candidates;
+  candidates.k = std::min(k, n > 0 ? n - 1 : 0);
+  if (candidates.k == 0) return candidates;
+  candidates.neighbors.resize(n * candidates.k);
+
+  // Matrix instances have no geometry to index, so each row is scanned for its k smallest entries
+  if (cities.mode == Coordinates::EXPLICIT) {
+    if (rule != CandidateRule::NEAREST) {
+      throw std::runtime_error("Only nearest candidates are defined for explicit city sets.");
+    }
+    Parallel::parallelFor(0, n, [&](size_t i) {
+      thread_local std::vector<std::pair<size_t, uint32_t>> row;
+      row.clear();
+      for (uint32_t j = 0; j < n; j++) if (j != i) row.emplace_back(cities.distance(i, j), j);
+      std::partial_sort(row.begin(), row.begin() + candidates.k, row.end());
+      uint32_t* list = candidates.neighbors.data() + i * candidates.k;
+      for (size_t q = 0; q < candidates.k; q++) list[q] = row[q].second;
+    }, threads);
+    return candidates;
+  }
+
+  SpatialGrid grid(cities);
+  Parallel::parallelFor(0, n, [&](size_t i) {
+    thread_local std::vector<uint32_t> found, picked;
+    uint32_t* list = candidates.neighbors.data() + i * candidates.k;
+    if (rule == CandidateRule::NEAREST) {
+      grid.nearest(i, candidates.k, found);
+      std::copy(found.begin(), found.end(), list);
+      return;
+    }
+
+    // K / 4 per quadrant (at least one), then the nearest cities overall until the list is full
+    picked.clear();
+    for (int q = 0; q < 4; q++) {
+      grid.nearest(i, std::max<size_t>(1, candidates.k / 4), found, q);
+      picked.insert(picked.end(), found.begin(), found.end());
+    }
+    grid.nearest(i, candidates.k, found);
+    for (const uint32_t& j : found) {
+      if (picked.size() >= candidates.k) break;
+      if (std::find(picked.begin(), picked.end(), j) == picked.end()) picked.push_back(j);
+    }
+    picked.resize(std::min(picked.size(), candidates.k));
+    std::stable_sort(picked.begin(), picked.end(), [&](const uint32_t& a, const uint32_t& b) {
+      return cities.distance(i, a) < cities.distance(i, b);
+    });
+    std::copy(picked.begin(), picked.end(), list);
+  }, threads);
+  return candidates;
+}
+
+namespace {
+  // Quadrant candidates per city that stand in for a Delaunay graph above `ALPHA_DENSE_MAX_CITIES`
+  constexpr size_t ALPHA_SPARSE_K = 12;
+
+  /**
+   * A minimum 1-tree: a minimum spanning tree plus the second-cheapest edge of one of its leaves
+   * (the leaf's tree edge is its cheapest, so removing the leaf leaves a minimum spanning tree of the rest).
+   */
+  struct OneTree {
+    std::vector<uint32_t> order;   // every city after its parent; order[0] is the root
+    std::vector<uint32_t> parent;  // parent[root] == root
+    std::vector<double> up;        // penalized weight of the edge to the parent
+    uint32_t special, extra;       // the leaf & the far end of its second edge
+    double length;                 // penalized length less twice the penalties: a lower bound on any tour
+    std::vector<uint32_t> degree;
+  };
+
+  /**
+   * Computes minimum 1-trees & alpha values under node penalties pi: alpha(i, j) is how much the minimum 1-tree
+   * grows when it is forced to contain edge (i, j), i.e. w(i, j) less the heaviest edge on the tree path from i
+   * to j (or less the heavier 1-tree edge of the special leaf when either end is that leaf).
+   *
+   * Small sets use the complete graph with distances computed on demand; larger sets use only the edges of a
+   * sparse quadrant graph, which is connected and contains the nearest city in every direction.
+   */
+  class Alpha {
+  public:
+    Alpha(const TSP::CitySet& cities_, const size_t& threads_)
+      : cities{cities_}, n{cities_.size()}, pi(cities_.size(), 0.0), threads{threads_} {
+      if (n > TSP::ALPHA_DENSE_MAX_CITIES) {
+        const bool geometric = cities.mode != TSP::Coordinates::EXPLICIT;
+        graph = TSP::buildCandidates(cities, ALPHA_SPARSE_K, geometric ? TSP::CandidateRule::QUADRANT
+                                                                       : TSP::CandidateRule::NEAREST, threads);
+      }
+    }
+
+    void ascend(const size_t& iterations);
+    TSP::Candidates select(const size_t& k);
+
+  private:
+    const TSP::CitySet& cities;
+    const size_t n;
+    std::vector<double> pi;
+    const size_t threads;
+    TSP::Candidates graph;
+
+    bool sparse() const { return graph.k > 0; }
+    double weight(const size_t& i, const size_t& j) const { return cities.distance(i, j) + pi[i] + pi[j]; }
+    OneTree tree() const;
+    void spanDense(OneTree& t) const;
+    bool spanSparse(OneTree& t) const;
+  };
+
+  // Prim's algorithm over the complete graph, rooted at city 0
+  void Alpha::spanDense(OneTree& t) const {
+    std::vector<double> key(n, std::numeric_limits<double>::infinity());
+    std::vector<bool> in_tree(n, false);
+    key[0] = 0;
+    t.parent[0] = 0;
+    for (size_t step = 0; step < n; step++) {
+      size_t v = 0;
+      double best = std::numeric_limits<double>::infinity();
+      for (size_t u = 0; u < n; u++) {
+        if (!in_tree[u] && key[u] < best) { best = key[u]; v = u; }
+      }
+      in_tree[v] = true;
+      t.order.push_back(v);
+      t.up[v] = key[v];
+      for (size_t u = 0; u < n; u++) {
+        if (in_tree[u]) continue;
+        const double w = weight(v, u);
+        if (w < key[u]) { key[u] = w; t.parent[u] = v; }
+      }
+    }
+  }
+
+  // Kruskal's algorithm over the quadrant graph, then a breadth-first pass from city 0 to root the tree
+  bool Alpha::spanSparse(OneTree& t) const {
+    std::vector<std::pair<double, std::pair<uint32_t, uint32_t>>> edges;
+    edges.reserve(n * graph.k);
+    for (uint32_t i = 0; i < n; i++) {
+      for (size_t q = 0; q < graph.k; q++) {
+        const uint32_t j = graph.of(i)[q];
+        edges.push_back({weight(i, j), {std::min(i, j), std::max(i, j)}});
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<uint32_t> set(n);
+    std::iota(set.begin(), set.end(), 0);
+    auto find = [&](uint32_t v) {
+      while (set[v] != v) v = set[v] = set[set[v]];
+      return v;
+    };
+    std::vector<std::vector<std::pair<uint32_t, double>>> adj(n);
+    size_t joined = 0;
+    for (const auto& e : edges) {
+      const uint32_t a = find(e.second.first), b = find(e.second.second);
+      if (a == b) continue;
+      set[a] = b;
+      adj[e.second.first].push_back({e.second.second, e.first});
+      adj[e.second.second].push_back({e.second.first, e.first});
+      joined++;
+    }
+    if (joined + 1 != n) return false;
+
+    t.parent[0] = 0;
+    t.up[0] = 0;
+    t.order.push_back(0);
+    for (size_t head = 0; head < t.order.size(); head++) {
+      const uint32_t v = t.order[head];
+      for (const auto& edge : adj[v]) {
+        if (edge.first == t.parent[v] && v != 0) continue;
+        t.parent[edge.first] = v;
+        t.up[edge.first] = edge.second;
+        t.order.push_back(edge.first);
+      }
+    }
+    return true;
+  }
+
+  OneTree Alpha::tree() const {
+    OneTree t;
+    t.parent.assign(n, 0);
+    t.up.assign(n, 0.0);
+    t.order.reserve(n);
+    // The quadrant graph is connected; should rounding ever split it, fall back to the complete graph
+    if (!sparse() || !spanSparse(t)) {
+      t.order.clear();
+      spanDense(t);
+    }
+
+    t.degree.assign(n, 0);
+    t.length = 0;
+    for (size_t v = 1; v < n; v++) {
+      const uint32_t c = t.order[v];
+      t.degree[c]++;
+      t.degree[t.parent[c]]++;
+      t.length += t.up[c];
+    }
+
+    // Of all leaves, take the one whose second-cheapest edge is longest; it tightens the bound the most
+    t.special = t.order[0];
+    t.extra = t.parent[t.special];
+    double extra_weight = -std::numeric_limits<double>::infinity();
+    for (uint32_t leaf = 0; leaf < n; leaf++) {
+      if (t.degree[leaf] != 1) continue;
+      const uint32_t neighbor = leaf == t.order[0] ? t.order[1] : t.parent[leaf];
+      uint32_t second = neighbor;
+      double second_weight = std::numeric_limits<double>::infinity();
+      auto consider = [&](const uint32_t& j) {
+        if (j == leaf || j == neighbor) return;
+        const double w = weight(leaf, j);
+        if (w < second_weight) { second_weight = w; second = j; }
+      };
+      if (sparse()) for (size_t q = 0; q < graph.k; q++) consider(graph.of(leaf)[q]);
+      else for (uint32_t j = 0; j < n; j++) consider(j);
+      if (second != neighbor && second_weight > extra_weight) {
+        extra_weight = second_weight;
+        t.special = leaf;
+        t.extra = second;
+      }
+    }
+    if (extra_weight > -std::numeric_limits<double>::infinity()) {
+      t.length += extra_weight;
+      t.degree[t.special]++;
+      t.degree[t.extra]++;
+    }
+    for (size_t v = 0; v < n; v++) t.length -= 2 * pi[v];
+    return t;
+  }
+
+  /**
+   * Subgradient ascent on the penalties with the schedule of `branchAndBound`: the step doubles while the
+   * bound improves during the initial phase, then step & period halve each round. Keeps the best penalties.
+   */
+  void Alpha::ascend(const size_t& iterations) {
+    if (iterations == 0 || n < 3) return;
+    OneTree t = tree();
+    double best_bound = t.length;
+    std::vector<double> best_pi = pi, last_v(n);
+    for (size_t v = 0; v < n; v++) last_v[v] = t.degree[v] - 2.0;
+
+    size_t period = std::max<size_t>(iterations / 2, 1), used = 0;
+    bool initial_phase = true;
+    double step = 1.0;
+    while (used < iterations && period > 0) {
+      for (size_t p = 1; p <= period && used < iterations; p++, used++) {
+        bool tour = true;
+        for (size_t v = 0; v < n; v++) tour = tour && t.degree[v] == 2;
+        if (tour) { pi = best_pi; return; }
+        for (size_t v = 0; v < n; v++) {
+          const double deviation = t.degree[v] - 2.0;
+          pi[v] += step * (0.7 * deviation + 0.3 * last_v[v]);
+          last_v[v] = deviation;
+        }
+
+        t = tree();
+        if (t.length > best_bound + 1e-9) {
+          best_bound = t.length;
+          best_pi = pi;
+          if (initial_phase) step *= 2;
+        } else if (initial_phase && p > period / 2) {
+          initial_phase = false;
+          p = 0;
+          step = 3 * step / 4;
+        }
+      }
+      period /= 2;
+      step /= 2;
+    }
+    pi = best_pi;
+  }
+
+  /**
+   * Keeps the k cities of smallest alpha for every city (ties broken by distance, then index). In the
+   * complete graph, one sweep over the tree in root-first order gives the heaviest path edge from city i
+   * to every other city in O(n) time & memory per city; in the sparse graph a walk of the tree from city i
+   * stops as soon as every graph neighbor of i has been reached.
+   */
+  TSP::Candidates Alpha::select(const size_t& k) {
+    TSP::Candidates candidates;
+    candidates.k = std::min(k, sparse() ? graph.k : (n > 0 ? n - 1 : 0));
+    if (candidates.k == 0) return candidates;
+    candidates.neighbors.resize(n * candidates.k);
+    const OneTree t = tree();
+
+    // Edges at the special leaf only compete with the heavier of its two 1-tree edges
+    const uint32_t s = t.special;
+    const uint32_t s_tree = s == t.order[0] ? t.order[1] : t.parent[s];
+    const double s_limit = std::max(weight(s, s_tree), weight(s, t.extra));
+    auto special = [&](const uint32_t& i, const uint32_t& j) {
+      const uint32_t other = i == s ? j : i;
+      return other == s_tree || other == t.extra ? 0.0 : weight(i, j) - s_limit;
+    };
+
+    std::vector<std::vector<uint32_t>> children;
+    if (sparse()) {
+      children.resize(n);
+      for (size_t v = 1; v < n; v++) children[t.parent[t.order[v]]].push_back(t.order[v]);
+    }
+
+    Parallel::parallelFor(0, n, [&](size_t i) {
+      thread_local std::vector<double> beta;
+      thread_local std::vector<uint32_t> mark;  // mark[j] == i: j is an ancestor of i, or a graph neighbor of i
+      thread_local std::vector<std::pair<std::pair<double, size_t>, uint32_t>> best;
+      if (mark.size() != n) { beta.assign(n, 0.0); mark.assign(n, UINT32_MAX); }
+      best.clear();
+      auto offer = [&](const uint32_t& j, const double& alpha) {
+        best.push_back({{alpha, cities.distance(i, j)}, j});
+      };
+
+      if (i == s) {
+        for (uint32_t j = 0; j < n; j++) if (j != s) offer(j, special(s, j));
+      } else if (!sparse()) {
+        // beta[j] = heaviest edge on the tree path from i to j; i's ancestors are filled walking up from i
+        beta[i] = -std::numeric_limits<double>::infinity();
+        mark[i] = i;
+        for (uint32_t u = i; u != t.order[0]; u = t.parent[u]) {
+          beta[t.parent[u]] = std::max(beta[u], t.up[u]);
+          mark[t.parent[u]] = i;
+        }
+        for (size_t v = 1; v < n; v++) {
+          const uint32_t j = t.order[v];
+          if (mark[j] != i) beta[j] = std::max(beta[t.parent[j]], t.up[j]);
+        }
+        for (uint32_t j = 0; j < n; j++) {
+          if (j != i) offer(j, j == s ? special(i, j) : weight(i, j) - beta[j]);
+        }
+      } else {
+        // Walk the tree outward from i until every graph neighbor of i has its path maximum
+        thread_local std::vector<uint32_t> walked;
+        thread_local std::vector<std::pair<uint32_t, double>> stack;
+        if (walked.size() != n) walked.assign(n, UINT32_MAX);
+        const uint32_t* near = graph.of(i);
+        size_t remaining = 0;
+        for (size_t q = 0; q < graph.k; q++) {
+          if (near[q] == s) offer(s, special(i, s));
+          else { mark[near[q]] = i; remaining++; }
+        }
+        walked[i] = i;
+        stack.assign(1, {uint32_t(i), -std::numeric_limits<double>::infinity()});
+        while (!stack.empty() && remaining > 0) {
+          const uint32_t v = stack.back().first;
+          const double heaviest = stack.back().second;
+          stack.pop_back();
+          auto visit = [&](const uint32_t& u, const double& w) {
+            if (u == s || walked[u] == i) return;
+            walked[u] = i;
+            const double path = std::max(heaviest, w);
+            if (mark[u] == i) { offer(u, weight(i, u) - path); remaining--; }
+            stack.push_back({u, path});
+          };
+          if (v != t.order[0]) visit(t.parent[v], t.up[v]);
+          for (const uint32_t& c : children[v]) visit(c, t.up[c]);
+        }
+      }
+
+      const size_t keep = std::min(candidates.k, best.size());
+      std::partial_sort(best.begin(), best.begin() + keep, best.end());
+      uint32_t* list = candidates.neighbors.data() + i * candidates.k;
+      for (size_t q = 0; q < candidates.k; q++) list[q] = best[std::min(q, keep - 1)].second;
+    }, threads);
+    return candidates;
+  }
+}
+
+/**
+ * Builds alpha-nearness candidate lists (Helsgaun's LKH): alpha(i, j) is how much a minimum 1-tree grows when
+ * it must contain edge (i, j), which picks edges of optimal tours far more reliably than distance does.
+ *
+ * @param cities The cities to connect.
+ * @param k The number of candidates per city.
+ * @param ascent Subgradient iterations that optimize node penalties before alpha values are taken; 0 uses
+ *               plain distances.
+ * @param threads The number of threads computing alpha values.
+ * @return The candidate lists, each ordered by increasing alpha.
+ * @throws std::runtime_error If `cities` is an asymmetric matrix.
+ */
+TSP::Candidates TSP::alphaCandidates(const CitySet& cities, const size_t& k, const size_t& ascent,
+                                     const size_t& threads) {
+  if (!cities.symmetric()) throw std::runtime_error("Alpha-nearness needs symmetric distances.");
+  Alpha alpha(cities, threads);
+  alpha.ascend(ascent);
+  return alpha.select(k);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "CitySet.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  // Above this many cities alpha values are only computed for edges of a sparse quadrant graph
+  constexpr size_t ALPHA_DENSE_MAX_CITIES = 12000;
+
+  /**
+   * Fixed-width candidate neighbor lists: the candidates of city i are neighbors[i * k .. i * k + k).
+   */
+  struct Candidates {
+    size_t k;
+    std::vector<uint32_t> neighbors;
+
+    Candidates() : k{0}, neighbors{std::vector<uint32_t>()} {};
+
+    /**
+     * @param i The index of a city.
+     * @return A pointer to the k candidates of city i.
+     */
+    const uint32_t* of(const size_t& i) const { return neighbors.data() + i * k; }
+  };
+
+  /**
+   * How candidate lists choose their cities.
+   *
+   * @details
+   * - `NEAREST` takes the K nearest cities.
+   * - `QUADRANT` takes the K / 4 nearest cities in each quadrant around the city, then fills any slots left
+   *   by sparse quadrants with the nearest remaining cities, so clustered or coastal cities keep neighbors on
+   *   every side.
+   * - `ALPHA` takes the K cities of smallest alpha-nearness, without penalties; see `alphaCandidates`.
+   * - `POPMUSIC` takes the nearest of a city's neighbors in five POPMUSIC tours; see `popmusicCandidates`.
+   *
+   * `EXPLICIT` city sets support `NEAREST` (each matrix row is scanned, so asymmetric sets get their nearest
+   * cities by outgoing distance) & `ALPHA` (symmetric sets) only.
+   */
+  enum class CandidateRule { NEAREST, QUADRANT, ALPHA, POPMUSIC };
+
+  /**
+   * Builds candidate lists for every city using a spatial grid, in parallel across cities.
+   *
+   * @param cities The cities to connect.
+   * @param k The number of candidates per city.
+   * @param rule How the candidates are chosen.
+   * @param threads The number of threads building lists.
+   * @return The candidate lists, each ordered by increasing distance (by increasing alpha for `ALPHA`).
+   * @throws std::runtime_error If `cities` is `EXPLICIT` & the rule needs coordinates.
+   */
+  Candidates buildCandidates(const CitySet& cities, const size_t& k, const CandidateRule& rule,
+                             const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Builds K-nearest candidate lists for every city using a spatial grid, in parallel across cities.
+   *
+   * @param cities The cities to connect.
+   * @param k The number of candidates per city.
+   * @param threads The number of threads building lists.
+   * @return The candidate lists, each ordered by increasing distance.
+   */
+  Candidates nearestCandidates(const CitySet& cities, const size_t& k,
+                               const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Builds alpha-nearness candidate lists (Helsgaun's LKH): alpha(i, j) is how much a minimum 1-tree grows when
+   * it must contain edge (i, j), which picks edges of optimal tours far more reliably than distance does.
+   *
+   * @details
+   * Up to `ALPHA_DENSE_MAX_CITIES` cities, every pair is considered in O(n^2) time & O(n) memory per thread,
+   * computing distances on demand. Larger sets only consider the edges of a quadrant graph with 12
+   * neighbors per city, standing in for a Delaunay triangulation, so at most 12 candidates are returned.
+   * `EXPLICIT` sets use their 12 nearest neighbors instead, falling back to every pair if that graph is split.
+   *
+   * @param cities The cities to connect.
+   * @param k The number of candidates per city.
+   * @param ascent Subgradient iterations that optimize node penalties before alpha values are taken; 0 uses
+   *               plain distances.
+   * @param threads The number of threads computing alpha values.
+   * @return The candidate lists, each ordered by increasing alpha.
+   * @throws std::runtime_error If `cities` is an asymmetric matrix.
+   */
+  Candidates alphaCandidates(const CitySet& cities, const size_t& k = 5, const size_t& ascent = 0,
+                             const size_t& threads = Parallel::defaultThreads());
+};
@@ -0,0 +1,293 @@
+#include "CitySet.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  // SplitMix64 finalizer, spreading ids over hash slots
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+}
+
+/**
+ * @param ids The id of every city, by index.
+ * @return Whether every id is distinct. A repeated id maps to its first city.
+ */
+bool TSP::IdIndex::build(const std::vector<size_t>& ids) {
+  const size_t n = ids.size();
+  slots.clear();
+  keys.clear();
+  if (n == 0) return true;
+
+  const auto range = std::minmax_element(ids.begin(), ids.end());
+  base = *range.first;
+  const size_t span = *range.second - base;
+  hashed = span >= DENSE_SPAN * n;
+  bool distinct = true;
+  if (!hashed) {
+    slots.assign(span + 1, NONE);
+    for (size_t i = 0; i < n; i++) {
+      uint32_t& slot = slots[ids[i] - base];
+      if (slot == NONE) slot = uint32_t(i);
+      else distinct = false;
+    }
+    return distinct;
+  }
+
+  // Linear probing in a power-of-two table at most half full
+  size_t capacity = 1;
+  while (capacity < 2 * n) capacity <<= 1;
+  slots.assign(capacity, NONE);
+  keys.assign(capacity, 0);
+  for (size_t i = 0; i < n; i++) {
+    size_t s = mix(ids[i]) & (capacity - 1);
+    while (slots[s] != NONE && keys[s] != ids[i]) s = (s + 1) & (capacity - 1);
+    if (slots[s] != NONE) { distinct = false; continue; }
+    slots[s] = uint32_t(i);
+    keys[s] = ids[i];
+  }
+  return distinct;
+}
+
+/**
+ * @param id Any id.
+ * @return The index of the city with this id, or `NONE`.
+ */
+uint32_t TSP::IdIndex::find(const size_t& id) const {
+  if (slots.empty()) return NONE;
+  if (!hashed) return id >= base && id - base < slots.size() ? slots[id - base] : NONE;
+  const size_t mask = slots.size() - 1;
+  for (size_t s = mix(id) & mask; slots[s] != NONE; s = (s + 1) & mask) {
+    if (keys[s] == id) return slots[s];
+  }
+  return NONE;
+}
+
+/**
+ * Copies the given cities, in order, into a new set.
+ *
+ * @param cities The cities to copy.
+ */
+TSP::CitySet::CitySet(const std::vector<Node>& cities) {
+  ids.reserve(cities.size());
+  xs.reserve(cities.size());
+  ys.reserve(cities.size());
+  for (const Node& city : cities) {
+    ids.push_back(city.id);
+    xs.push_back(city.x);
+    ys.push_back(city.y);
+  }
+  indexIds();
+}
+
+TSP::CitySet::CitySet(const std::list<Node>& cities) : CitySet(std::vector<Node>(cities.begin(), cities.end())) {}
+
+/**
+ * Creates an `EXPLICIT` set over the matrix's cities, with ids 1..n.
+ *
+ * @param matrix_ The edge weights between the cities.
+ */
+TSP::CitySet::CitySet(DistanceMatrix matrix_) : mode{Coordinates::EXPLICIT}, matrix{std::move(matrix_)} {
+  ids.resize(matrix.n);
+  for (size_t i = 0; i < matrix.n; i++) ids[i] = i + 1;
+  indexIds();
+}
+
+/**
+ * Rebuilds `id_index` from `ids`; the constructors do this, code that fills `ids` itself calls it after.
+ *
+ * @return Whether every id is distinct. A repeated id maps to its first city.
+ */
+bool TSP::CitySet::indexIds() {
+  return id_index.build(ids);
+}
+
+/**
+ * @param id The id of a city in the set.
+ * @return The city's index, in O(1).
+ * @throws std::runtime_error If no city has this id.
+ */
+size_t TSP::CitySet::index(const size_t& id) const {
+  const uint32_t i = id_index.find(id);
+  if (i == IdIndex::NONE) throw std::runtime_error("No city has id " + std::to_string(id) + ".");
+  return i;
+}
+
+/**
+ * Converts the set to `FIXED_POINT` coordinates, releasing the double arrays (halving coordinate memory).
+ * Coordinates are rounded to the nearest multiple of 1 / scale, so a scale of 10^d reproduces coordinates
+ * written with d decimals (as in TSPLIB files such as ja9847) exactly.
+ *
+ * @param scale_ The number of fixed-point units per coordinate unit.
+ * @throws std::runtime_error If the set spans 2^30 or more units along either axis at this scale.
+ */
+void TSP::CitySet::toFixedPoint(const int64_t& scale_) {
+  if (mode == Coordinates::EXPLICIT) throw std::runtime_error("Explicit city sets have no coordinates.");
+  if (mode == Coordinates::FIXED_POINT || ids.empty()) return;
+  scale = scale_;
+  const size_t n = size();
+  std::vector<int64_t> sx(n), sy(n);
+  for (size_t i = 0; i < n; i++) {
+    sx[i] = std::llround(xs[i] * scale);
+    sy[i] = std::llround(ys[i] * scale);
+  }
+  origin_x = *std::min_element(sx.begin(), sx.end());
+  origin_y = *std::min_element(sy.begin(), sy.end());
+
+  // Offsets below 2^30 keep dx^2 + dy^2 below 2^61, so 4 * (dx^2 + dy^2) fits in 64 bits
+  constexpr int64_t LIMIT = int64_t(1) << 30;
+  if (*std::max_element(sx.begin(), sx.end()) - origin_x >= LIMIT ||
+      *std::max_element(sy.begin(), sy.end()) - origin_y >= LIMIT) {
+    throw std::runtime_error("Coordinates span too far for fixed-point mode at this scale.");
+  }
+
+  fixed_xs.resize(n);
+  fixed_ys.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    fixed_xs[i] = uint32_t(sx[i] - origin_x);
+    fixed_ys[i] = uint32_t(sy[i] - origin_y);
+  }
+  std::vector<double>().swap(xs);
+  std::vector<double>().swap(ys);
+  std::vector<float>().swap(float_xs);
+  std::vector<float>().swap(float_ys);
+  mode = Coordinates::FIXED_POINT;
+}
+
+/**
+ * Converts the set to `FLOAT` coordinates. The double arrays are kept for exact recomputation only.
+ * Records the largest coordinate conversion error, from which `floatErrorBound` is derived.
+ *
+ * @throws std::runtime_error If the set is in `FIXED_POINT` mode, whose doubles have been released.
+ */
+void TSP::CitySet::toFloat() {
+  if (mode == Coordinates::FIXED_POINT) throw std::runtime_error("Fixed-point city sets cannot be converted to float.");
+  if (mode == Coordinates::EXPLICIT) throw std::runtime_error("Explicit city sets have no coordinates.");
+  if (mode == Coordinates::FLOAT || ids.empty()) return;
+  const size_t n = size();
+  float_origin_x = *std::min_element(xs.begin(), xs.end());
+  float_origin_y = *std::min_element(ys.begin(), ys.end());
+
+  // Offsets from the minimum keep magnitudes (and so float rounding errors) as small as the set's extent
+  float_xs.resize(n);
+  float_ys.resize(n);
+  float_error = 0;
+  for (size_t i = 0; i < n; i++) {
+    const double dx = xs[i] - float_origin_x, dy = ys[i] - float_origin_y;
+    float_xs[i] = float(dx);
+    float_ys[i] = float(dy);
+    float_error = std::max({float_error, std::abs(double(float_xs[i]) - dx), std::abs(double(float_ys[i]) - dy)});
+  }
+  const double extent = std::max(*std::max_element(float_xs.begin(), float_xs.end()),
+                                 *std::max_element(float_ys.begin(), float_ys.end()));
+  // Two converted coordinates per difference, plus half an ulp for rounding the float subtraction
+  float_error = 2 * float_error + extent * std::ldexp(1.0, -24) + 1e-9 * (1 + extent);
+  mode = Coordinates::FLOAT;
+}
+
+/**
+ * A bound on |float distance - double distance| for a pair of cities in `FLOAT` mode, covering the
+ * coordinate conversion error, the float subtraction, and the relative error of the float square root.
+ *
+ * @param distance The unrounded float distance between the pair.
+ * @return The error bound, in coordinate units.
+ */
+double TSP::CitySet::floatErrorBound(const double& distance) const {
+  // |dx| & |dy| each err by at most float_error, moving the length by at most sqrt(2) times that; squaring,
+  // adding & the square root contribute a few float ulps relative to the distance
+  return std::sqrt(2.0) * float_error + distance * std::ldexp(8.0, -24);
+}
+
+/**
+ * @return The number of cities in the set.
+ */
+size_t TSP::CitySet::size() const {
+  return ids.size();
+}
+
+/**
+ * @param i The index of a city in the set.
+ * @return The city's x-coordinate, in any coordinate storage mode.
+ * @throws std::runtime_error If the set is `EXPLICIT`.
+ */
+double TSP::CitySet::x(const size_t& i) const {
+  if (mode == Coordinates::EXPLICIT) throw std::runtime_error("Explicit city sets have no coordinates.");
+  if (mode == Coordinates::FIXED_POINT) return double(origin_x + int64_t(fixed_xs[i])) / scale;
+  return xs[i];
+}
+
+/**
+ * @param i The index of a city in the set.
+ * @return The city's y-coordinate, in any coordinate storage mode.
+ * @throws std::runtime_error If the set is `EXPLICIT`.
+ */
+double TSP::CitySet::y(const size_t& i) const {
+  if (mode == Coordinates::EXPLICIT) throw std::runtime_error("Explicit city sets have no coordinates.");
+  if (mode == Coordinates::FIXED_POINT) return double(origin_y + int64_t(fixed_ys[i])) / scale;
+  return ys[i];
+}
+
+/**
+ * @param i The index of a city in the set.
+ * @return The city as a `Node`.
+ */
+Node TSP::CitySet::node(const size_t& i) const {
+  return Node(ids[i], x(i), y(i));
+}
+
+/**
+ * Calculates the Euclidean distance between two cities of the set, rounded exactly like `Node::distance`.
+ *
+ * @param i The index of the first city.
+ * @param j The index of the second city.
+ * @return The distance as an integer.
+ */
+size_t TSP::CitySet::distance(const size_t& i, const size_t& j) const {
+  if (mode == Coordinates::EXPLICIT) return matrix(i, j);
+  if (mode == Coordinates::FIXED_POINT) {
+    // round(sqrt(S) / scale) = floor((2 sqrt(S) + scale) / (2 scale)), and floor(2 sqrt(S)) = isqrt(4 S)
+    return (isqrt(4 * fixedSquaredDistance(i, j)) + scale) / (2 * scale);
+  }
+  if (mode == Coordinates::FLOAT) {
+    const float fx = float_xs[i] - float_xs[j], fy = float_ys[i] - float_ys[j];
+    const float approx = std::sqrt(fx * fx + fy * fy);
+    const float whole = std::floor(approx);
+    const float fraction = approx - whole;
+    // Far enough from a .5 boundary that the double distance rounds the same way
+    if (std::abs(fraction - 0.5f) > floatErrorBound(approx)) return size_t(whole) + (fraction > 0.5f);
+  }
+  double dx = (xs[i] - xs[j]);
+  double dy = (ys[i] - ys[j]);
+  return std::round(sqrt(dx * dx + dy * dy));
+}
+
+/**
+ * The exact squared distance between two cities in `FIXED_POINT` mode, in fixed-point units squared.
+ *
+ * @param i The index of the first city.
+ * @param j The index of the second city.
+ * @return The squared distance; always below 2^61.
+ */
+uint64_t TSP::CitySet::fixedSquaredDistance(const size_t& i, const size_t& j) const {
+  const int64_t dx = int64_t(fixed_xs[i]) - int64_t(fixed_xs[j]);
+  const int64_t dy = int64_t(fixed_ys[i]) - int64_t(fixed_ys[j]);
+  return uint64_t(dx * dx) + uint64_t(dy * dy);
+}
+
+/**
+ * Computes floor(sqrt(v)) exactly, from a floating-point estimate corrected with integer arithmetic.
+ *
+ * @param v The value; must be below 2^63.
+ * @return The integer square root.
+ */
+uint64_t TSP::isqrt(const uint64_t& v) {
+  uint64_t r = uint64_t(std::sqrt(double(v)));
+  while (r * r > v) r--;
+  while ((r + 1) * (r + 1) <= v) r++;
+  return r;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "Node.hpp"
+
+namespace TSP {
+  /**
+   * How a `CitySet` stores its coordinates.
+   *
+   * @details
+   * - `DOUBLE` keeps the parsed coordinates in `xs` & `ys`; distances match `Node::distance`.
+   * - `FIXED_POINT` keeps each coordinate as an unsigned 32-bit offset from the set's minimum, in units of
+   *   1 / `scale`, in `fixed_xs` & `fixed_ys`. Squared distances are exact integers and are rounded with an
+   *   integer square root, so distances are bitwise reproducible across compilers & instruction sets.
+   * - `FLOAT` keeps single-precision offsets from the set's minimum in `float_xs` & `float_ys` for the hot
+   *   loops, plus the doubles for the rare distance whose float value lies within `floatErrorBound` of a
+   *   rounding boundary; distances match `Node::distance` exactly while reading half the bytes.
+   * - `EXPLICIT` has no coordinates at all; distances are read from `matrix`, as given by a TSPLIB
+   *   EDGE_WEIGHT_SECTION. Algorithms that need geometry (grids, curves, coarsening) reject such sets.
+   */
+  enum class Coordinates { DOUBLE, FIXED_POINT, FLOAT, EXPLICIT };
+
+  /**
+   * Explicit integer edge weights between n cities in one contiguous array. Symmetric matrices keep only the
+   * lower triangle & diagonal, row by row, so entry (i, j) with j <= i is at i * (i + 1) / 2 + j (the TSPLIB
+   * LOWER_DIAG_ROW order); asymmetric matrices keep all n * n entries row-major.
+   */
+  struct DistanceMatrix {
+    size_t n = 0;
+    bool symmetric = true;
+    std::vector<uint32_t> weights;
+
+    /**
+     * @param i The index of the city the edge leaves.
+     * @param j The index of the city the edge enters.
+     * @return The weight of edge (i, j).
+     */
+    uint32_t operator()(const size_t& i, const size_t& j) const {
+      if (!symmetric) return weights[i * n + j];
+      return i >= j ? weights[i * (i + 1) / 2 + j] : weights[j * (j + 1) / 2 + i];
+    }
+  };
+
+  /**
+   * Maps city ids to indices. Ids spanning at most `DENSE_SPAN` slots per city use a flat table indexed by
+   * id - min id, as TSPLIB's 1..n numbering does; sparse or huge ids use an open-addressing hash table.
+   */
+  class IdIndex {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr size_t DENSE_SPAN = 4;
+
+    /**
+     * @param ids The id of every city, by index.
+     * @return Whether every id is distinct. A repeated id maps to its first city.
+     */
+    bool build(const std::vector<size_t>& ids);
+
+    /**
+     * @param id Any id.
+     * @return The index of the city with this id, or `NONE`.
+     */
+    uint32_t find(const size_t& id) const;
+
+  private:
+    bool hashed = false;
+    size_t base = 0;
+    std::vector<uint32_t> slots;
+    std::vector<size_t> keys;
+  };
+
+  /**
+   * A structure-of-arrays copy of a set of cities, so kernels can stream or gather coordinates without
+   * touching ids. City i of the set is (ids[i], x(i), y(i)); algorithms refer to cities by this index.
+   */
+  struct CitySet {
+    std::vector<size_t> ids;
+    std::vector<double> xs;
+    std::vector<double> ys;
+
+    Coordinates mode = Coordinates::DOUBLE;
+    std::vector<uint32_t> fixed_xs;
+    std::vector<uint32_t> fixed_ys;
+    int64_t scale = 1;
+    int64_t origin_x = 0, origin_y = 0;
+
+    std::vector<float> float_xs;
+    std::vector<float> float_ys;
+    double float_origin_x = 0, float_origin_y = 0;
+    double float_error = 0;
+
+    DistanceMatrix matrix;
+    IdIndex id_index;
+
+    // Optional CVRP data from a TSPLIB file: demand by index (empty if none), vehicle capacity & depot indices
+    std::vector<size_t> demands;
+    size_t capacity = 0;
+    std::vector<uint32_t> depots;
+
+    CitySet() = default;
+
+    /**
+     * Copies the given cities, in order, into a new set.
+     *
+     * @param cities The cities to copy.
+     */
+    explicit CitySet(const std::vector<Node>& cities);
+    explicit CitySet(const std::list<Node>& cities);
+
+    /**
+     * Creates an `EXPLICIT` set over the matrix's cities, with ids 1..n.
+     *
+     * @param matrix_ The edge weights between the cities.
+     */
+    explicit CitySet(DistanceMatrix matrix_);
+
+    /**
+     * @return Whether d(i, j) = d(j, i) for every pair, i.e. the set is not an asymmetric matrix.
+     */
+    bool symmetric() const { return mode != Coordinates::EXPLICIT || matrix.symmetric; }
+
+    /**
+     * Rebuilds `id_index` from `ids`; the constructors do this, code that fills `ids` itself calls it after.
+     *
+     * @return Whether every id is distinct. A repeated id maps to its first city.
+     */
+    bool indexIds();
+
+    /**
+     * @param id The id of a city in the set.
+     * @return The city's index, in O(1).
+     * @throws std::runtime_error If no city has this id.
+     */
+    size_t index(const size_t& id) const;
+
+    /**
+     * Converts the set to `FIXED_POINT` coordinates, releasing the double arrays (halving coordinate memory).
+     * Coordinates are rounded to the nearest multiple of 1 / scale, so a scale of 10^d reproduces coordinates
+     * written with d decimals (as in TSPLIB files such as ja9847) exactly.
+     *
+     * @param scale_ The number of fixed-point units per coordinate unit.
+     * @throws std::runtime_error If the set spans 2^30 or more units along either axis at this scale, or is
+     *                            `EXPLICIT`.
+     */
+    void toFixedPoint(const int64_t& scale_ = 10000);
+
+    /**
+     * Converts the set to `FLOAT` coordinates. The double arrays are kept for exact recomputation only.
+     * Records the largest coordinate conversion error, from which `floatErrorBound` is derived.
+     *
+     * @throws std::runtime_error If the set is in `FIXED_POINT` mode, whose doubles have been released, or
+     *                            is `EXPLICIT`.
+     */
+    void toFloat();
+
+    /**
+     * A bound on |float distance - double distance| for a pair of cities in `FLOAT` mode, covering the
+     * coordinate conversion error, the float subtraction, and the relative error of the float square root.
+     *
+     * @param distance The unrounded float distance between the pair.
+     * @return The error bound, in coordinate units.
+     */
+    double floatErrorBound(const double& distance) const;
+
+    /**
+     * @return The number of cities in the set.
+     */
+    size_t size() const;
+
+    /**
+     * @param i The index of a city in the set.
+     * @return The city's x-coordinate, in any coordinate storage mode.
+     * @throws std::runtime_error If the set is `EXPLICIT`.
+     */
+    double x(const size_t& i) const;
+
+    /**
+     * @param i The index of a city in the set.
+     * @return The city's y-coordinate, in any coordinate storage mode.
+     * @throws std::runtime_error If the set is `EXPLICIT`.
+     */
+    double y(const size_t& i) const;
+
+    /**
+     * @param i The index of a city in the set.
+     * @return The city as a `Node`.
+     */
+    Node node(const size_t& i) const;
+
+    /**
+     * Calculates the Euclidean distance between two cities of the set, rounded to the nearest integer.
+     * In `DOUBLE` & `FLOAT` modes this is exactly `Node::distance`; in `FIXED_POINT` mode it is the exact
+     * rounding of the true distance between the fixed-point coordinates; in `EXPLICIT` mode it is the
+     * matrix entry.
+     *
+     * @param i The index of the first city.
+     * @param j The index of the second city.
+     * @return The distance as an integer.
+     */
+    size_t distance(const size_t& i, const size_t& j) const;
+
+    /**
+     * The exact squared distance between two cities in `FIXED_POINT` mode, in fixed-point units squared.
+     *
+     * @param i The index of the first city.
+     * @param j The index of the second city.
+     * @return The squared distance; always below 2^61.
+     */
+    uint64_t fixedSquaredDistance(const size_t& i, const size_t& j) const;
+  };
+
+  /**
+   * Computes floor(sqrt(v)) exactly, from a floating-point estimate corrected with integer arithmetic.
+   *
+   * @param v The value; must be below 2^63.
+   * @return The integer square root.
+   */
+  uint64_t isqrt(const uint64_t& v);
+};
@@ -0,0 +1,154 @@
+#include "HeldKarp.hpp"
+#include "Kernels.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  // Unreachable table entry; small enough that INF + INF never overflows 32 bits
+  constexpr uint32_t INF = 0x3fffffff;
+
+  // Number of free cities (excluding the start) handled by stack-allocated specializations
+  constexpr size_t FIXED_MAX_FREE = 11;
+
+  /**
+   * Returns min over k of (row[k] + col[k]), clamped to INF.
+   * Entries of `row` for cities outside the predecessor set hold INF, so the reduction can
+   * run over the whole contiguous row without branching on set membership.
+   */
+  inline uint32_t minPlus(const uint32_t* row, const uint32_t* col, const size_t& m) {
+    return std::min(Kernels::minPlus(row, col, m), INF);
+  }
+
+  /**
+   * Fills the Held-Karp table & reconstructs an optimal order starting at city 0.
+   *
+   * The table is indexed [mask][j] with the m = n - 1 free cities as bits, so every predecessor
+   * row dp[mask ^ (1 << j)] is contiguous and the inner loop is a dense min-plus reduction against
+   * column j of the distance matrix (stored transposed for unit stride).
+   *
+   * @tparam M The number of free cities when known at compile time, or 0 for the heap-allocated variant.
+   * @param closed Whether the order returns to city 0; otherwise it is a path that must end at city n - 1.
+   */
+  template <size_t M>
+  std::vector<size_t> solve(const std::vector<uint32_t>& dist, const size_t& n, const bool& closed) {
+    constexpr bool fixed = M != 0;
+    const size_t m = fixed ? M : n - 1;
+    const size_t full = (size_t(1) << m) - 1;
+
+    std::array<uint32_t, fixed ? (M << M) : 1> stack_table;
+    std::array<uint32_t, fixed ? M * M : 1> stack_into;
+    std::vector<uint32_t> heap_table(fixed ? 0 : (m << m));
+    std::vector<uint32_t> heap_into(fixed ? 0 : m * m);
+    uint32_t* dp = fixed ? stack_table.data() : heap_table.data();
+    uint32_t* into = fixed ? stack_into.data() : heap_into.data();
+
+    // into[j * m + k] = cost of traveling from free city k to free city j
+    for (size_t j = 0; j < m; j++) {
+      for (size_t k = 0; k < m; k++) {
+        into[j * m + k] = std::min(dist[(k + 1) * n + (j + 1)], INF);
+      }
+    }
+
+    std::fill(dp, dp + (m << m), INF);
+    for (size_t j = 0; j < m; j++) dp[(size_t(1) << j) * m + j] = std::min(dist[j + 1], INF);
+
+    for (size_t mask = 1; mask <= full; mask++) {
+      if (!(mask & (mask - 1))) continue;
+      uint32_t* row = dp + mask * m;
+      for (size_t j = 0; j < m; j++) {
+        if (!(mask & (size_t(1) << j))) continue;
+        row[j] = minPlus(dp + (mask ^ (size_t(1) << j)) * m, into + j * m, m);
+      }
+    }
+
+    // Close the tour back to city 0, or end the path at the last city
+    size_t last = m - 1;
+    uint32_t best = UINT32_MAX;
+    for (size_t j = 0; closed && j < m; j++) {
+      uint32_t cost = dp[full * m + j] + std::min(dist[(j + 1) * n], INF);
+      if (cost < best) { best = cost; last = j; }
+    }
+
+    // Walk predecessors back from the final city
+    std::vector<size_t> order(n);
+    size_t mask = full;
+    for (size_t pos = n - 1; pos > 1; pos--) {
+      order[pos] = last + 1;
+      const size_t prev = mask ^ (size_t(1) << last);
+      const uint32_t target = dp[mask * m + last];
+      for (size_t k = 0; k < m; k++) {
+        if ((prev & (size_t(1) << k)) && dp[prev * m + k] + into[last * m + k] == target) {
+          last = k;
+          break;
+        }
+      }
+      mask = prev;
+    }
+    order[1] = last + 1;
+    order[0] = 0;
+    return order;
+  }
+
+  using Solver = std::vector<size_t> (*)(const std::vector<uint32_t>&, const size_t&, const bool&);
+
+  template <size_t... Ms>
+  constexpr std::array<Solver, sizeof...(Ms)> fixedSolvers(std::index_sequence<Ms...>) {
+    return {{ &solve<Ms + 1>... }};
+  }
+
+  // fixed_solvers[m - 1] solves a problem with m free cities
+  constexpr auto fixed_solvers = fixedSolvers(std::make_index_sequence<FIXED_MAX_FREE>{});
+
+  std::vector<size_t> dispatch(const std::vector<uint32_t>& dist, const size_t& n, const bool& closed) {
+    if (n > TSP::HELD_KARP_MAX_CITIES) throw std::runtime_error("Held-Karp subproblem is too large.");
+    if (dist.size() != n * n) throw std::runtime_error("Held-Karp distance matrix does not match city count.");
+    if (n <= 1) return std::vector<size_t>(n, 0);
+
+    const size_t m = n - 1;
+    if (m <= FIXED_MAX_FREE) return fixed_solvers[m - 1](dist, n, closed);
+    return solve<0>(dist, n, closed);
+  }
+}
+
+/**
+ * Computes an optimal visiting order over a dense distance matrix using the Held-Karp bitmask dynamic program.
+ * Subproblems of up to 12 cities are solved by compile-time specializations whose tables live on the stack.
+ *
+ * @param dist A row-major n * n matrix where entry (i * n + j) is the cost of traveling from city i to city j.
+ * @param n The number of cities in the matrix.
+ * @return The indices of the cities in an optimal closed visiting order, starting with index 0.
+ * @throws std::runtime_error If n exceeds `HELD_KARP_MAX_CITIES` or `dist` is not n * n.
+ */
+std::vector<size_t> TSP::heldKarpOrder(const std::vector<uint32_t>& dist, const size_t& n) {
+  return dispatch(dist, n, true);
+}
+
+/**
+ * Computes a shortest path over a dense distance matrix that starts at city 0, visits every city once,
+ * and ends at city n - 1, using the same dynamic program as `heldKarpOrder`.
+ *
+ * @param dist A row-major n * n matrix where entry (i * n + j) is the cost of traveling from city i to city j.
+ * @param n The number of cities in the matrix, including both fixed endpoints.
+ * @return The indices of the cities in visiting order, starting with 0 & ending with n - 1.
+ * @throws std::runtime_error If n exceeds `HELD_KARP_MAX_CITIES` or `dist` is not n * n.
+ */
+std::vector<size_t> TSP::heldKarpPath(const std::vector<uint32_t>& dist, const size_t& n) {
+  return dispatch(dist, n, false);
+}
+
+/**
+ * Constructs an optimal tour over a small set of cities using the Held-Karp dynamic program.
+ *
+ * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+ * @return A `TSP::Tour` object representing an optimal path, its edge weights, and its total distance.
+ * @throws std::runtime_error If there are more than `HELD_KARP_MAX_CITIES` cities.
+ */
+TSP::Tour TSP::heldKarp(const std::vector<Node>& cities) {
+  std::vector<size_t> order = heldKarpOrder(distanceMatrix(cities), cities.size());
+  std::vector<Node> path;
+  path.reserve(order.size());
+  for (const size_t& i : order) path.push_back(cities[i]);
+  return makeTour(path);
+}
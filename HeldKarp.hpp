@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Node.hpp"
+#include "TSP.hpp"
+
+namespace TSP {
+  // The largest number of cities the Held-Karp solver accepts (its table grows as n * 2^n)
+  constexpr size_t HELD_KARP_MAX_CITIES = 20;
+
+  /**
+   * Computes an optimal visiting order over a dense distance matrix using the Held-Karp bitmask dynamic program.
+   * Subproblems of up to 12 cities are solved by compile-time specializations whose tables live on the stack.
+   *
+   * @param dist A row-major n * n matrix where entry (i * n + j) is the cost of traveling from city i to city j.
+   * @param n The number of cities in the matrix.
+   * @return The indices of the cities in an optimal closed visiting order, starting with index 0.
+   * @throws std::runtime_error If n exceeds `HELD_KARP_MAX_CITIES` or `dist` is not n * n.
+   */
+  std::vector<size_t> heldKarpOrder(const std::vector<uint32_t>& dist, const size_t& n);
+
+  /**
+   * Computes a shortest path over a dense distance matrix that starts at city 0, visits every city once,
+   * and ends at city n - 1, using the same dynamic program as `heldKarpOrder`.
+   *
+   * @param dist A row-major n * n matrix where entry (i * n + j) is the cost of traveling from city i to city j.
+   * @param n The number of cities in the matrix, including both fixed endpoints.
+   * @return The indices of the cities in visiting order, starting with 0 & ending with n - 1.
+   * @throws std::runtime_error If n exceeds `HELD_KARP_MAX_CITIES` or `dist` is not n * n.
+   */
+  std::vector<size_t> heldKarpPath(const std::vector<uint32_t>& dist, const size_t& n);
+
+  /**
+   * Constructs an optimal tour over a small set of cities using the Held-Karp dynamic program.
+   *
+   * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+   * @return A `TSP::Tour` object representing an optimal path, its edge weights, and its total distance.
+   * @throws std::runtime_error If there are more than `HELD_KARP_MAX_CITIES` cities.
+   */
+  Tour heldKarp(const std::vector<Node>& cities);
+};
@@ -0,0 +1,572 @@
+#include "Kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace {
+  constexpr double INFINITE = std::numeric_limits<double>::infinity();
+
+  // The best value of a batch & its position; the position is the batch size while there is none
+  struct Best {
+    double value;
+    size_t index;
+  };
+
+  inline double scalarDistance(const double* xs, const double* ys, const uint32_t& i, const uint32_t& j) {
+    double dx = (xs[i] - xs[j]);
+    double dy = (ys[i] - ys[j]);
+    return std::round(sqrt(dx * dx + dy * dy));
+  }
+
+  // Whether distance d to targets[q] beats the best so far: shorter, or as short to a lower city index
+  inline void keepNearest(Best& best, const double& d, const size_t& q, const uint32_t* targets) {
+    if (d < best.value || (d == best.value && targets[q] < targets[best.index])) best = {d, q};
+  }
+
+  // The scalar kernels over double coordinates, for positions [k, count) of a batch; the vector kernels finish
+  // their batches with them
+  void gainRange(const double* xs, const double* ys, const uint32_t& u, const uint32_t& v, const uint32_t* cs,
+                 const uint32_t* ds, size_t k, const size_t& count, Best& best) {
+    for (; k < count; k++) {
+      double gain = scalarDistance(xs, ys, cs[k], ds[k]) - scalarDistance(xs, ys, u, cs[k]) -
+                    scalarDistance(xs, ys, v, ds[k]);
+      if (gain > best.value) best = {gain, k};
+    }
+  }
+
+  void nearestRange(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets, size_t q,
+                    const size_t& count, Best& best) {
+    for (; q < count; q++) keepNearest(best, scalarDistance(xs, ys, from, targets[q]), q, targets);
+  }
+
+  void distancesRange(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets, size_t q,
+                      const size_t& count, double* out) {
+    for (; q < count; q++) out[q] = scalarDistance(xs, ys, from, targets[q]);
+  }
+
+  uint32_t minPlusRange(const uint32_t* row, const uint32_t* col, size_t k, const size_t& count, uint32_t best) {
+    for (; k < count; k++) best = std::min(best, row[k] + col[k]);
+    return best;
+  }
+
+  Best gainScalar(const double* xs, const double* ys, const uint32_t& u, const uint32_t& v, const uint32_t* cs,
+                  const uint32_t* ds, const size_t& count) {
+    Best best{-INFINITE, count};
+    gainRange(xs, ys, u, v, cs, ds, 0, count, best);
+    return best;
+  }
+
+  size_t nearestScalar(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                       const size_t& count) {
+    Best best{INFINITE, count};
+    nearestRange(xs, ys, from, targets, 0, count, best);
+    return best.index;
+  }
+
+  void distancesScalar(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                       const size_t& count, double* out) {
+    distancesRange(xs, ys, from, targets, 0, count, out);
+  }
+
+  uint32_t minPlusScalar(const uint32_t* row, const uint32_t* col, const size_t& count) {
+    return minPlusRange(row, col, 0, count, UINT32_MAX);
+  }
+
+  // Gains through `CitySet::distance`, one move at a time: fixed-point sets round with integer square roots,
+  // explicit sets read their matrix & float sets recheck near rounding boundaries
+  Best exactGain(const TSP::CitySet& cities, const uint32_t& u, const uint32_t& v, const uint32_t* cs,
+                 const uint32_t* ds, const size_t& count) {
+    Best best{-INFINITE, count};
+    for (size_t k = 0; k < count; k++) {
+      double gain = double(cities.distance(cs[k], ds[k])) - double(cities.distance(u, cs[k])) -
+                    double(cities.distance(v, ds[k]));
+      if (gain > best.value) best = {gain, k};
+    }
+    return best;
+  }
+
+#if defined(KERNELS_X86)
+  // round() for non-negative lanes: floor, plus one when the fraction (exact for doubles) is at least 1/2
+  TARGET_SSE42 inline __m128d roundHalfUp(const __m128d& x) {
+    __m128d whole = _mm_floor_pd(x);
+    __m128d up = _mm_cmpge_pd(_mm_sub_pd(x, whole), _mm_set1_pd(0.5));
+    return _mm_add_pd(whole, _mm_and_pd(up, _mm_set1_pd(1.0)));
+  }
+
+  // Kept as separate multiplies & adds so the result matches the scalar (non-contracted) expression
+  TARGET_SSE42 inline __m128d distance(const __m128d& ax, const __m128d& ay, const __m128d& bx, const __m128d& by) {
+    __m128d dx = _mm_sub_pd(ax, bx), dy = _mm_sub_pd(ay, by);
+    return roundHalfUp(_mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+  }
+
+  // SSE has no gathers; two loads fill the lanes
+  TARGET_SSE42 inline __m128d gather2(const double* values, const uint32_t* indices) {
+    return _mm_set_pd(values[indices[1]], values[indices[0]]);
+  }
+
+  // Wider lanes are filled the same way: gather instructions are microcoded on many CPUs (e.g. under the Gather
+  // Data Sampling mitigation) & were up to 2.5x slower than separate loads for nearest neighbor
+  TARGET_AVX2 inline __m256d gather4(const double* values, const uint32_t* indices) {
+    return _mm256_set_pd(values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+  }
+
+  TARGET_AVX2 inline __m256 gather8(const float* values, const uint32_t* indices) {
+    return _mm256_set_ps(values[indices[7]], values[indices[6]], values[indices[5]], values[indices[4]],
+                         values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+  }
+
+  TARGET_AVX512 inline __m512d gather8(const double* values, const uint32_t* indices) {
+    return _mm512_set_pd(values[indices[7]], values[indices[6]], values[indices[5]], values[indices[4]],
+                         values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+  }
+
+  TARGET_AVX2 inline __m256d roundHalfUp(const __m256d& x) {
+    __m256d whole = _mm256_floor_pd(x);
+    __m256d up = _mm256_cmp_pd(_mm256_sub_pd(x, whole), _mm256_set1_pd(0.5), _CMP_GE_OQ);
+    return _mm256_add_pd(whole, _mm256_and_pd(up, _mm256_set1_pd(1.0)));
+  }
+
+  TARGET_AVX2 inline __m256d distance(const __m256d& ax, const __m256d& ay, const __m256d& bx, const __m256d& by) {
+    __m256d dx = _mm256_sub_pd(ax, bx), dy = _mm256_sub_pd(ay, by);
+    return roundHalfUp(_mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+  }
+
+  // The zero-masked forms avoid reading an undefined source, which GCC warns about
+  TARGET_AVX512 inline __m512d roundHalfUp(const __m512d& x) {
+    __m512d whole = _mm512_maskz_roundscale_pd(0xff, x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __mmask8 up = _mm512_cmp_pd_mask(_mm512_sub_pd(x, whole), _mm512_set1_pd(0.5), _CMP_GE_OQ);
+    return _mm512_mask_add_pd(whole, up, whole, _mm512_set1_pd(1.0));
+  }
+
+  TARGET_AVX512 inline __m512d distance(const __m512d& ax, const __m512d& ay, const __m512d& bx, const __m512d& by) {
+    __m512d dx = _mm512_sub_pd(ax, bx), dy = _mm512_sub_pd(ay, by);
+    return roundHalfUp(_mm512_maskz_sqrt_pd(0xff, _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy))));
+  }
+
+  /**
+   * Rounds eight float distances, flagging (all bits set) the lanes within the error bound of a .5 boundary,
+   * where the double distance might round the other way.
+   */
+  TARGET_AVX2 inline __m256i roundFloat(const __m256& d, const __m256& error, const __m256& relative, __m256& near) {
+    const __m256 whole = _mm256_floor_ps(d);
+    const __m256 fraction = _mm256_sub_ps(d, whole);
+    const __m256 off = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(fraction, _mm256_set1_ps(0.5f)));
+    const __m256 bound = _mm256_add_ps(error, _mm256_mul_ps(relative, d));
+    near = _mm256_or_ps(near, _mm256_cmp_ps(off, bound, _CMP_LE_OQ));
+    const __m256 up = _mm256_and_ps(_mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(whole, up));
+  }
+
+  TARGET_AVX2 inline __m256 floatDistance(const __m256& ax, const __m256& ay, const __m256& bx, const __m256& by) {
+    const __m256 dx = _mm256_sub_ps(ax, bx), dy = _mm256_sub_ps(ay, by);
+    return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+  }
+
+  TARGET_SSE42 Best gainSse42(const double* xs, const double* ys, const uint32_t& u, const uint32_t& v,
+                              const uint32_t* cs, const uint32_t* ds, const size_t& count) {
+    Best best{-INFINITE, count};
+    const __m128d ux = _mm_set1_pd(xs[u]), uy = _mm_set1_pd(ys[u]);
+    const __m128d vx = _mm_set1_pd(xs[v]), vy = _mm_set1_pd(ys[v]);
+    size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+      const __m128d cx = gather2(xs, cs + k), cy = gather2(ys, cs + k);
+      const __m128d dx = gather2(xs, ds + k), dy = gather2(ys, ds + k);
+      __m128d gain = _mm_sub_pd(distance(cx, cy, dx, dy),
+                                _mm_add_pd(distance(ux, uy, cx, cy), distance(vx, vy, dx, dy)));
+      alignas(16) double lanes[2];
+      _mm_store_pd(lanes, gain);
+      for (size_t l = 0; l < 2; l++) {
+        if (lanes[l] > best.value) best = {lanes[l], k + l};
+      }
+    }
+    gainRange(xs, ys, u, v, cs, ds, k, count, best);
+    return best;
+  }
+
+  TARGET_AVX2 Best gainAvx2(const double* xs, const double* ys, const uint32_t& u, const uint32_t& v,
+                            const uint32_t* cs, const uint32_t* ds, const size_t& count) {
+    Best best{-INFINITE, count};
+    const __m256d ux = _mm256_set1_pd(xs[u]), uy = _mm256_set1_pd(ys[u]);
+    const __m256d vx = _mm256_set1_pd(xs[v]), vy = _mm256_set1_pd(ys[v]);
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+      const __m256d cx = gather4(xs, cs + k), cy = gather4(ys, cs + k);
+      const __m256d dx = gather4(xs, ds + k), dy = gather4(ys, ds + k);
+      __m256d gain = _mm256_sub_pd(distance(cx, cy, dx, dy),
+                                   _mm256_add_pd(distance(ux, uy, cx, cy), distance(vx, vy, dx, dy)));
+      alignas(32) double lanes[4];
+      _mm256_store_pd(lanes, gain);
+      for (size_t l = 0; l < 4; l++) {
+        if (lanes[l] > best.value) best = {lanes[l], k + l};
+      }
+    }
+    gainRange(xs, ys, u, v, cs, ds, k, count, best);
+    return best;
+  }
+
+  TARGET_AVX512 Best gainAvx512(const double* xs, const double* ys, const uint32_t& u, const uint32_t& v,
+                                const uint32_t* cs, const uint32_t* ds, const size_t& count) {
+    Best best{-INFINITE, count};
+    const __m512d ux = _mm512_set1_pd(xs[u]), uy = _mm512_set1_pd(ys[u]);
+    const __m512d vx = _mm512_set1_pd(xs[v]), vy = _mm512_set1_pd(ys[v]);
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+      const __m512d cx = gather8(xs, cs + k), cy = gather8(ys, cs + k);
+      const __m512d dx = gather8(xs, ds + k), dy = gather8(ys, ds + k);
+      __m512d gain = _mm512_sub_pd(distance(cx, cy, dx, dy),
+                                   _mm512_add_pd(distance(ux, uy, cx, cy), distance(vx, vy, dx, dy)));
+      alignas(64) double lanes[8];
+      _mm512_store_pd(lanes, gain);
+      for (size_t l = 0; l < 8; l++) {
+        if (lanes[l] > best.value) best = {lanes[l], k + l};
+      }
+    }
+    gainRange(xs, ys, u, v, cs, ds, k, count, best);
+    return best;
+  }
+
+  // Float sets gather half as many bytes; lanes near a rounding boundary are recomputed exactly
+  TARGET_AVX2 Best floatGainAvx2(const TSP::CitySet& cities, const uint32_t& u, const uint32_t& v,
+                                 const uint32_t* cs, const uint32_t* ds, const size_t& count) {
+    auto exact = [&](const size_t& q) {
+      return double(cities.distance(cs[q], ds[q])) - double(cities.distance(u, cs[q])) -
+             double(cities.distance(v, ds[q]));
+    };
+    Best best{-INFINITE, count};
+    const float* fxs = cities.float_xs.data();
+    const float* fys = cities.float_ys.data();
+    const __m256 ux = _mm256_set1_ps(fxs[u]), uy = _mm256_set1_ps(fys[u]);
+    const __m256 vx = _mm256_set1_ps(fxs[v]), vy = _mm256_set1_ps(fys[v]);
+    // The same bound as CitySet::floatErrorBound, padded for evaluating it in single precision
+    const __m256 error = _mm256_set1_ps(float(cities.floatErrorBound(0) * 1.01));
+    const __m256 relative = _mm256_set1_ps(float(std::ldexp(8.0, -24) * 1.01));
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+      const __m256 cx = gather8(fxs, cs + k), cy = gather8(fys, cs + k);
+      const __m256 dx = gather8(fxs, ds + k), dy = gather8(fys, ds + k);
+      __m256 near = _mm256_setzero_ps();
+      const __m256i cd = roundFloat(floatDistance(cx, cy, dx, dy), error, relative, near);
+      const __m256i uc = roundFloat(floatDistance(ux, uy, cx, cy), error, relative, near);
+      const __m256i vd = roundFloat(floatDistance(vx, vy, dx, dy), error, relative, near);
+      alignas(32) int32_t lanes[8];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_sub_epi32(cd, _mm256_add_epi32(uc, vd)));
+      const int recheck = _mm256_movemask_ps(near);
+      for (size_t l = 0; l < 8; l++) {
+        const double gain = (recheck >> l) & 1 ? exact(k + l) : double(lanes[l]);
+        if (gain > best.value) best = {gain, k + l};
+      }
+    }
+    for (; k < count; k++) {
+      const double gain = exact(k);
+      if (gain > best.value) best = {gain, k};
+    }
+    return best;
+  }
+
+  TARGET_SSE42 size_t nearestSse42(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                   const size_t& count) {
+    Best best{INFINITE, count};
+    const __m128d fx = _mm_set1_pd(xs[from]), fy = _mm_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 2 <= count; q += 2) {
+      const __m128d d = distance(fx, fy, gather2(xs, targets + q), gather2(ys, targets + q));
+      if (_mm_movemask_pd(_mm_cmple_pd(d, _mm_set1_pd(best.value))) == 0) continue;
+      alignas(16) double lanes[2];
+      _mm_store_pd(lanes, d);
+      for (size_t l = 0; l < 2; l++) keepNearest(best, lanes[l], q + l, targets);
+    }
+    nearestRange(xs, ys, from, targets, q, count, best);
+    return best.index;
+  }
+
+  TARGET_AVX2 size_t nearestAvx2(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                 const size_t& count) {
+    Best best{INFINITE, count};
+    const __m256d fx = _mm256_set1_pd(xs[from]), fy = _mm256_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 4 <= count; q += 4) {
+      const __m256d d = distance(fx, fy, gather4(xs, targets + q), gather4(ys, targets + q));
+      if (_mm256_movemask_pd(_mm256_cmp_pd(d, _mm256_set1_pd(best.value), _CMP_LE_OQ)) == 0) continue;
+      alignas(32) double lanes[4];
+      _mm256_store_pd(lanes, d);
+      for (size_t l = 0; l < 4; l++) keepNearest(best, lanes[l], q + l, targets);
+    }
+    nearestRange(xs, ys, from, targets, q, count, best);
+    return best.index;
+  }
+
+  TARGET_AVX512 size_t nearestAvx512(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                     const size_t& count) {
+    Best best{INFINITE, count};
+    const __m512d fx = _mm512_set1_pd(xs[from]), fy = _mm512_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 8 <= count; q += 8) {
+      const __m512d d = distance(fx, fy, gather8(xs, targets + q), gather8(ys, targets + q));
+      if (_mm512_cmp_pd_mask(d, _mm512_set1_pd(best.value), _CMP_LE_OQ) == 0) continue;
+      alignas(64) double lanes[8];
+      _mm512_store_pd(lanes, d);
+      for (size_t l = 0; l < 8; l++) keepNearest(best, lanes[l], q + l, targets);
+    }
+    nearestRange(xs, ys, from, targets, q, count, best);
+    return best.index;
+  }
+
+  TARGET_SSE42 void distancesSse42(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                   const size_t& count, double* out) {
+    const __m128d fx = _mm_set1_pd(xs[from]), fy = _mm_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 2 <= count; q += 2) {
+      _mm_storeu_pd(out + q, distance(fx, fy, gather2(xs, targets + q), gather2(ys, targets + q)));
+    }
+    distancesRange(xs, ys, from, targets, q, count, out);
+  }
+
+  TARGET_AVX2 void distancesAvx2(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                 const size_t& count, double* out) {
+    const __m256d fx = _mm256_set1_pd(xs[from]), fy = _mm256_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 4 <= count; q += 4) {
+      _mm256_storeu_pd(out + q, distance(fx, fy, gather4(xs, targets + q), gather4(ys, targets + q)));
+    }
+    distancesRange(xs, ys, from, targets, q, count, out);
+  }
+
+  TARGET_AVX512 void distancesAvx512(const double* xs, const double* ys, const uint32_t& from, const uint32_t* targets,
+                                     const size_t& count, double* out) {
+    const __m512d fx = _mm512_set1_pd(xs[from]), fy = _mm512_set1_pd(ys[from]);
+    size_t q = 0;
+    for (; q + 8 <= count; q += 8) {
+      _mm512_storeu_pd(out + q, distance(fx, fy, gather8(xs, targets + q), gather8(ys, targets + q)));
+    }
+    distancesRange(xs, ys, from, targets, q, count, out);
+  }
+
+  TARGET_SSE42 uint32_t minPlusSse42(const uint32_t* row, const uint32_t* col, const size_t& count) {
+    __m128i lanes = _mm_set1_epi32(-1);
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + k));
+      lanes = _mm_min_epu32(lanes, _mm_add_epi32(a, b));
+    }
+    lanes = _mm_min_epu32(lanes, _mm_shuffle_epi32(lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+    lanes = _mm_min_epu32(lanes, _mm_shuffle_epi32(lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+    return minPlusRange(row, col, k, count, uint32_t(_mm_cvtsi128_si32(lanes)));
+  }
+
+  TARGET_AVX2 uint32_t minPlusAvx2(const uint32_t* row, const uint32_t* col, const size_t& count) {
+    __m256i lanes = _mm256_set1_epi32(-1);
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + k));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + k));
+      lanes = _mm256_min_epu32(lanes, _mm256_add_epi32(a, b));
+    }
+    __m128i half = _mm_min_epu32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return minPlusRange(row, col, k, count, uint32_t(_mm_cvtsi128_si32(half)));
+  }
+
+  TARGET_AVX512 uint32_t minPlusAvx512(const uint32_t* row, const uint32_t* col, const size_t& count) {
+    __m512i lanes = _mm512_set1_epi32(-1);
+    size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+      const __m512i a = _mm512_loadu_si512(row + k);
+      const __m512i b = _mm512_loadu_si512(col + k);
+      lanes = _mm512_maskz_min_epu32(0xffff, lanes, _mm512_add_epi32(a, b));
+    }
+    const __m256i quarter = _mm256_min_epu32(_mm512_maskz_extracti64x4_epi64(0xf, lanes, 0),
+                                             _mm512_maskz_extracti64x4_epi64(0xf, lanes, 1));
+    __m128i half = _mm_min_epu32(_mm256_castsi256_si128(quarter), _mm256_extracti128_si256(quarter, 1));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return minPlusRange(row, col, k, count, uint32_t(_mm_cvtsi128_si32(half)));
+  }
+#endif
+
+  // The implementations of every kernel at one level
+  struct Table {
+    Best (*gain)(const double*, const double*, const uint32_t&, const uint32_t&, const uint32_t*, const uint32_t*,
+                 const size_t&);
+    Best (*float_gain)(const TSP::CitySet&, const uint32_t&, const uint32_t&, const uint32_t*, const uint32_t*,
+                       const size_t&);
+    size_t (*nearest)(const double*, const double*, const uint32_t&, const uint32_t*, const size_t&);
+    void (*distances)(const double*, const double*, const uint32_t&, const uint32_t*, const size_t&, double*);
+    uint32_t (*min_plus)(const uint32_t*, const uint32_t*, const size_t&);
+  };
+
+  // By level; the float kernel needs AVX2, so lower levels recompute every float gain exactly
+  const Table TABLES[] = {
+    {gainScalar, exactGain, nearestScalar, distancesScalar, minPlusScalar},
+#if defined(KERNELS_X86)
+    {gainSse42, exactGain, nearestSse42, distancesSse42, minPlusSse42},
+    {gainAvx2, floatGainAvx2, nearestAvx2, distancesAvx2, minPlusAvx2},
+    {gainAvx512, floatGainAvx2, nearestAvx512, distancesAvx512, minPlusAvx512},
+#endif
+  };
+
+  // The active level as an index into TABLES, or -1 until the first kernel call picks one
+  std::atomic<int> active{-1};
+
+  const Table& table() {
+    return TABLES[size_t(Kernels::activeLevel())];
+  }
+}
+
+/**
+ * @return The highest level the running CPU (& operating system) supports.
+ */
+Kernels::Level Kernels::supportedLevel() {
+#if defined(KERNELS_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return Level::AVX512;
+  if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+  if (__builtin_cpu_supports("sse4.2")) return Level::SSE4_2;
+#endif
+  return Level::SCALAR;
+}
+
+/**
+ * Picks the level on first use: TSP_KERNELS if it is set, otherwise the highest the CPU supports.
+ *
+ * @return The level in use.
+ * @throws std::runtime_error If TSP_KERNELS names an unknown or unsupported level.
+ */
+Kernels::Level Kernels::activeLevel() {
+  int level = active.load(std::memory_order_relaxed);
+  if (level < 0) {
+    const char* forced = std::getenv("TSP_KERNELS");
+    if (forced && *forced) setLevel(parseLevel(forced));
+    else active.store(int(supportedLevel()), std::memory_order_relaxed);
+    level = active.load(std::memory_order_relaxed);
+  }
+  return Level(level);
+}
+
+/**
+ * Forces the level every kernel runs at.
+ *
+ * @param level The level to use.
+ * @throws std::runtime_error If the CPU does not support `level`.
+ */
+void Kernels::setLevel(const Level& level) {
+  if (int(level) > int(supportedLevel())) {
+    throw std::runtime_error(std::string("This CPU does not support ") + levelName(level) + " kernels.");
+  }
+  active.store(int(level), std::memory_order_relaxed);
+}
+
+/**
+ * @param name scalar, sse4.2, avx2 or avx512.
+ * @return The level of that name.
+ * @throws std::runtime_error If no level has this name.
+ */
+Kernels::Level Kernels::parseLevel(const std::string& name) {
+  for (const Level& level : {Level::SCALAR, Level::SSE4_2, Level::AVX2, Level::AVX512}) {
+    if (name == levelName(level)) return level;
+  }
+  throw std::runtime_error("Unknown kernel level " + name + "; use scalar, sse4.2, avx2 or avx512.");
+}
+
+/**
+ * @param level A level.
+ * @return Its name.
+ */
+const char* Kernels::levelName(const Level& level) {
+  switch (level) {
+    case Level::SSE4_2: return "sse4.2";
+    case Level::AVX2: return "avx2";
+    case Level::AVX512: return "avx512";
+    default: return "scalar";
+  }
+}
+
+/**
+ * Evaluates a batch of moves that each replace an edge (c, d) with edges (u, c) & (v, d), returning the
+ * largest total gain base + d(c, d) - d(u, c) - d(v, d) and the first candidate that achieves it.
+ *
+ * @param cities The city set the indices refer to.
+ * @param u The city joined to each c.
+ * @param v The city joined to each d.
+ * @param cs The first endpoint of each candidate edge.
+ * @param ds The second endpoint of each candidate edge.
+ * @param count The number of candidate edges.
+ * @param base The gain shared by every move in the batch.
+ * @return The best gain & its index; index is `count` if the batch is empty.
+ */
+Kernels::Gain Kernels::bestGain(const TSP::CitySet& cities, const uint32_t& u, const uint32_t& v,
+                                const uint32_t* cs, const uint32_t* ds, const size_t& count, const long long& base) {
+  // Gains are integers far below 2^53, so they are exact in doubles
+  Best best;
+  if (cities.mode == TSP::Coordinates::FIXED_POINT || cities.mode == TSP::Coordinates::EXPLICIT) {
+    best = exactGain(cities, u, v, cs, ds, count);
+  } else if (cities.mode == TSP::Coordinates::FLOAT) {
+    best = table().float_gain(cities, u, v, cs, ds, count);
+  } else {
+    best = table().gain(cities.xs.data(), cities.ys.data(), u, v, cs, ds, count);
+  }
+  if (best.index == count) return {std::numeric_limits<long long>::min(), count};
+  return {base + (long long)best.value, best.index};
+}
+
+/**
+ * Finds the city of a batch nearest to `from`. Fixed-point & explicit sets go through `CitySet::distance`;
+ * double & float sets (which keep their doubles) use the vector kernels.
+ *
+ * @param cities The city set the indices refer to.
+ * @param from The city distances are measured from.
+ * @param targets The cities to choose from.
+ * @param count The number of targets.
+ * @return The position in `targets` of the nearest city, ties going to the lowest city index.
+ */
+size_t Kernels::nearest(const TSP::CitySet& cities, const uint32_t& from, const uint32_t* targets,
+                        const size_t& count) {
+  if (cities.mode == TSP::Coordinates::FIXED_POINT || cities.mode == TSP::Coordinates::EXPLICIT) {
+    Best best{INFINITE, count};
+    for (size_t q = 0; q < count; q++) keepNearest(best, double(cities.distance(from, targets[q])), q, targets);
+    return best.index;
+  }
+  return table().nearest(cities.xs.data(), cities.ys.data(), from, targets, count);
+}
+
+/**
+ * Computes the distances from one city to a batch of cities.
+ *
+ * @param cities The city set the indices refer to.
+ * @param from The city distances are measured from.
+ * @param targets The cities to measure to.
+ * @param count The number of targets.
+ * @param out Receives the distances.
+ */
+void Kernels::distances(const TSP::CitySet& cities, const uint32_t& from, const uint32_t* targets,
+                        const size_t& count, double* out) {
+  if (cities.mode == TSP::Coordinates::FIXED_POINT || cities.mode == TSP::Coordinates::EXPLICIT) {
+    for (size_t q = 0; q < count; q++) out[q] = double(cities.distance(from, targets[q]));
+    return;
+  }
+  table().distances(cities.xs.data(), cities.ys.data(), from, targets, count, out);
+}
+
+/**
+ * Computes min over k of (row[k] + col[k]).
+ *
+ * @param row The first terms.
+ * @param col The second terms.
+ * @param count The number of terms in each.
+ * @return The smallest sum, or UINT32_MAX if the batch is empty.
+ */
+uint32_t Kernels::minPlus(const uint32_t* row, const uint32_t* col, const size_t& count) {
+  return table().min_plus(row, col, count);
+}
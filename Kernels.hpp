@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "CitySet.hpp"
+
+namespace Kernels {
+  /**
+   * The best of a batch of move gains & the position of its candidate in the batch.
+   */
+  struct Gain {
+    long long gain;
+    size_t index;
+  };
+
+  /**
+   * The instruction sets a kernel implementation may use. Every level computes bitwise the same results;
+   * higher levels only evaluate more cities per instruction.
+   */
+  enum class Level { SCALAR, SSE4_2, AVX2, AVX512 };
+
+  /**
+   * @return The highest level the running CPU supports.
+   */
+  Level supportedLevel();
+
+  /**
+   * The level kernels run at: `supportedLevel()` unless the TSP_KERNELS environment variable (scalar, sse4.2,
+   * avx2 or avx512) or `setLevel` forces a lower one, e.g. to benchmark or test one implementation.
+   *
+   * @return The level in use.
+   * @throws std::runtime_error If TSP_KERNELS names an unknown level or one the CPU does not support.
+   */
+  Level activeLevel();
+
+  /**
+   * Forces the level every kernel runs at from now on.
+   *
+   * @param level The level to use.
+   * @throws std::runtime_error If the CPU does not support `level`.
+   */
+  void setLevel(const Level& level);
+
+  /**
+   * @param name scalar, sse4.2, avx2 or avx512.
+   * @return The level of that name.
+   * @throws std::runtime_error If no level has this name.
+   */
+  Level parseLevel(const std::string& name);
+
+  /**
+   * @param level A level.
+   * @return Its name, as `parseLevel` reads it.
+   */
+  const char* levelName(const Level& level);
+
+  /**
+   * Evaluates a batch of moves that each replace an edge (c, d) with edges (u, c) & (v, d), returning the
+   * largest total gain base + d(c, d) - d(u, c) - d(v, d) and the first candidate that achieves it.
+   *
+   * Every distance is rounded exactly like `Node::distance`, so gains are the integer tour-length changes.
+   * 2-opt uses u = a, v = b for the removed edge (a, b), with base = d(a, b); Or-opt uses the segment's
+   * endpoints for u & v, with base = the gain of removing the segment from its current position.
+   * Coordinates are gathered from the city set's arrays, two (SSE4.2), four (AVX2) or eight (AVX-512) moves at
+   * a time; float sets gather eight moves per AVX2 pass and recompute exactly only the lanes near a rounding
+   * boundary.
+   *
+   * @param cities The city set the indices refer to.
+   * @param u The city joined to each c.
+   * @param v The city joined to each d.
+   * @param cs The first endpoint of each candidate edge.
+   * @param ds The second endpoint of each candidate edge.
+   * @param count The number of candidate edges.
+   * @param base The gain shared by every move in the batch.
+   * @return The best gain & its index; index is `count` if the batch is empty.
+   */
+  Gain bestGain(const TSP::CitySet& cities, const uint32_t& u, const uint32_t& v,
+                const uint32_t* cs, const uint32_t* ds, const size_t& count, const long long& base);
+
+  /**
+   * Finds the city of a batch nearest to `from`, as `nearestNeighbor` steps do. Batches of lanes whose
+   * distances all exceed the best so far are skipped with one comparison.
+   *
+   * @param cities The city set the indices refer to.
+   * @param from The city distances are measured from.
+   * @param targets The cities to choose from.
+   * @param count The number of targets.
+   * @return The position in `targets` of the nearest city, ties going to the lowest city index; `count` if the
+   *         batch is empty.
+   */
+  size_t nearest(const TSP::CitySet& cities, const uint32_t& from, const uint32_t* targets, const size_t& count);
+
+  /**
+   * Computes the distances from one city to a batch of cities, each exactly `cities.distance(from, to[q])`.
+   *
+   * @param cities The city set the indices refer to.
+   * @param from The city distances are measured from.
+   * @param targets The cities to measure to.
+   * @param count The number of targets.
+   * @param out Receives the `count` distances, as whole doubles.
+   */
+  void distances(const TSP::CitySet& cities, const uint32_t& from, const uint32_t* targets, const size_t& count,
+                 double* out);
+
+  /**
+   * Computes min over k of (row[k] + col[k]), the inner reduction of the Held-Karp dynamic program, four (SSE4.2),
+   * eight (AVX2) or sixteen (AVX-512) sums at a time.
+   *
+   * @param row The first terms.
+   * @param col The second terms; no sum of a term of each may exceed UINT32_MAX.
+   * @param count The number of terms in each.
+   * @return The smallest sum, or UINT32_MAX if the batch is empty.
+   */
+  uint32_t minPlus(const uint32_t* row, const uint32_t* col, const size_t& count);
+};
@@ -0,0 +1,536 @@
+#include "LocalSearch.hpp"
+#include "HeldKarp.hpp"
+#include "Kernels.hpp"
+
+#include <atomic>
+#include <deque>
+#include <map>
+
+/**
+ * Improves a tour with the 2-opt heuristic: repeatedly removes two edges (a, b) & (c, d) and reconnects
+ * the tour as (a, c) & (b, d) by reversing the segment between them, until no exchange shortens the tour.
+ *
+ * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+ * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+ */
+TSP::Tour TSP::twoOpt(const Tour& tour) {
+  if (tour.path.size() < 5) return tour;
+
+  // Work on the open order; the closing edge is implied
+  std::vector<Node> order(tour.path.begin(), tour.path.end() - 1);
+  const size_t n = order.size();
+
+  bool improved = true;
+  while (improved) {
+    improved = false;
+    for (size_t i = 0; i + 2 < n; i++) {
+      const Node& a = order[i];
+      const Node& b = order[i+1];
+      const long long ab = a.distance(b);
+      // The edge leaving the last city closes the tour, so it is adjacent to (order[0], order[1])
+      for (size_t j = i + 2; j < (i == 0 ? n - 1 : n); j++) {
+        const Node& c = order[j];
+        const Node& d = order[(j + 1) % n];
+        long long delta = (long long)a.distance(c) + (long long)b.distance(d) - ab - (long long)c.distance(d);
+        if (delta < 0) {
+          std::reverse(order.begin() + i + 1, order.begin() + j + 1);
+          improved = true;
+          break;
+        }
+      }
+    }
+  }
+  return makeTour(order);
+}
+
+namespace {
+  // A 2-opt exchange replacing edges (order[i], order[i+1]) & (order[j], order[j+1]); reverses order[i+1..j]
+  struct Exchange {
+    long long gain;
+    size_t i, j;
+    uint64_t rank;
+  };
+
+  // SplitMix64 finalizer, used to rank equal-gain exchanges reproducibly
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * Finds the best improving exchange whose first edge starts at position i, if any.
+   * An exchange can only gain if one of its new edges is shorter than the removed edge it shares a city with,
+   * and a new edge is at least as long as either of its coordinate differences, so most candidates are
+   * skipped before any distance is computed.
+   */
+  Exchange bestExchange(const std::vector<Node>& order, const size_t& i) {
+    const size_t n = order.size();
+    const Node& a = order[i];
+    const Node& b = order[i+1];
+    const long long ab = a.distance(b);
+    Exchange best{0, i, i, 0};
+    for (size_t j = i + 2; j < (i == 0 ? n - 1 : n); j++) {
+      const Node& c = order[j];
+      const Node& d = order[(j + 1) % n];
+      const long long cd = c.distance(d);
+      if ((std::abs(a.x - c.x) >= ab || std::abs(a.y - c.y) >= ab) &&
+          (std::abs(b.x - d.x) >= cd || std::abs(b.y - d.y) >= cd)) continue;
+      long long gain = ab + cd - (long long)a.distance(c) - (long long)b.distance(d);
+      if (gain > best.gain) best = {gain, i, j, 0};
+    }
+    return best;
+  }
+
+  /**
+   * An array tour over city indices with a position table, supporting the moves of the candidate local search.
+   */
+  class ArrayTour {
+  public:
+    explicit ArrayTour(std::vector<uint32_t> order_) : order{std::move(order_)}, pos(order.size()), n{order.size()} {
+      for (size_t p = 0; p < n; p++) pos[order[p]] = p;
+    }
+
+    uint32_t succ(const uint32_t& c) const { return order[pos[c] + 1 == n ? 0 : pos[c] + 1]; }
+    uint32_t pred(const uint32_t& c) const { return order[pos[c] == 0 ? n - 1 : pos[c] - 1]; }
+
+    // How many steps forward from city `from` city `to` lies
+    size_t ahead(const uint32_t& from, const uint32_t& to) const { return (pos[to] + n - pos[from]) % n; }
+
+    /**
+     * Reverses the path running forward from city `from` to city `to`. When that path is longer than half the
+     * tour, the complementary path is reversed instead, which yields the same cycle traversed the other way.
+     */
+    void reverse(const uint32_t& from, const uint32_t& to) {
+      size_t i = pos[from], j = pos[to];
+      size_t len = (j + n - i) % n + 1;
+      if (2 * len > n) {
+        i = (j + 1) % n;
+        j = (pos[from] + n - 1) % n;
+        len = n - len;
+      }
+      for (size_t step = 0; step < len / 2; step++) {
+        std::swap(order[i], order[j]);
+        pos[order[i]] = i;
+        pos[order[j]] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j == 0 ? n - 1 : j - 1;
+      }
+    }
+
+    /**
+     * Moves the segment of `length` cities starting at `first` between the adjacent cities c & d, joining
+     * `joined` (an end of the segment) to c. Shifts whichever side of the tour between the segment & its
+     * destination is shorter.
+     */
+    void moveSegment(const uint32_t& first, const size_t& length, const uint32_t& c, const uint32_t& d,
+                     const uint32_t& joined) {
+      const uint32_t x = succ(c) == d ? c : d;
+      const uint32_t y = x == c ? d : c;
+      const uint32_t x_end = x == c ? joined : (joined == first ? order[(pos[first] + length - 1) % n] : first);
+
+      const size_t i = pos[first], j = (i + length - 1) % n;
+      std::vector<uint32_t> segment(length);
+      for (size_t q = 0; q < length; q++) segment[q] = order[(i + q) % n];
+      if (x_end != first) std::reverse(segment.begin(), segment.end());
+
+      const size_t forward = (pos[x] + n - j) % n, backward = (i + n - pos[y]) % n;
+      size_t start;
+      if (forward <= backward) {
+        for (size_t t = 0; t < forward; t++) place(order[(j + 1 + t) % n], (i + t) % n);
+        start = (i + forward) % n;
+      } else {
+        start = pos[y];
+        for (size_t t = backward; t-- > 0;) place(order[(start + t) % n], (start + length + t) % n);
+      }
+      for (size_t q = 0; q < length; q++) place(segment[q], (start + q) % n);
+    }
+
+    std::vector<uint32_t> order;
+
+  private:
+    std::vector<size_t> pos;
+    size_t n;
+
+    void place(const uint32_t& city, const size_t& p) {
+      order[p] = city;
+      pos[city] = p;
+    }
+  };
+
+  /**
+   * The candidate-list local search: 2-opt in both tour directions, then Or-opt of the segments starting at
+   * the city, applying the best improving move found for a city before moving on.
+   */
+  class CandidateSearch {
+  public:
+    CandidateSearch(const TSP::CitySet& cities_, const TSP::Candidates& candidates_, std::vector<uint32_t> order)
+      : cities{cities_}, candidates{candidates_}, tour(std::move(order)), n{cities_.size()},
+        queued(n, true), cs(2 * candidates_.k), ds(2 * candidates_.k) {
+      for (const uint32_t& c : tour.order) queue.push_back(c);
+    }
+
+    std::vector<uint32_t> run() {
+      while (!queue.empty()) {
+        const uint32_t a = queue.front();
+        queue.pop_front();
+        queued[a] = false;
+        if (twoOpt(a) || orOpt(a)) touch(a);
+      }
+      return tour.order;
+    }
+
+  private:
+    const TSP::CitySet& cities;
+    const TSP::Candidates& candidates;
+    ArrayTour tour;
+    const size_t n;
+    std::deque<uint32_t> queue;
+    std::vector<bool> queued;
+    std::vector<uint32_t> cs, ds;
+
+    void touch(const uint32_t& c) {
+      if (!queued[c]) { queued[c] = true; queue.push_back(c); }
+    }
+
+    long long dist(const uint32_t& i, const uint32_t& j) const { return cities.distance(i, j); }
+
+    bool twoOpt(const uint32_t& a) {
+      const size_t k = candidates.k;
+      const uint32_t* near = candidates.of(a);
+      for (int forward = 1; forward >= 0; forward--) {
+        const uint32_t b = forward ? tour.succ(a) : tour.pred(a);
+        for (size_t q = 0; q < k; q++) {
+          cs[q] = near[q];
+          ds[q] = forward ? tour.succ(near[q]) : tour.pred(near[q]);
+        }
+        Kernels::Gain best = Kernels::bestGain(cities, a, b, cs.data(), ds.data(), k, dist(a, b));
+        if (best.gain <= 0) continue;
+
+        const uint32_t c = cs[best.index], d = ds[best.index];
+        if (forward) tour.reverse(b, c);
+        else tour.reverse(a, d);
+        touch(b); touch(c); touch(d);
+        return true;
+      }
+      return false;
+    }
+
+    bool orOpt(const uint32_t& first) {
+      if (n < 8) return false;
+      uint32_t last = first;
+      for (size_t length = 1; length <= 3; length++, last = tour.succ(last)) {
+        const uint32_t p = tour.pred(first), next = tour.succ(last);
+        const long long removed = dist(p, first) + dist(last, next) - dist(p, next);
+        if (removed <= 0) continue;
+
+        auto inSegment = [&](const uint32_t& c) {
+          for (uint32_t s = first;; s = tour.succ(s)) {
+            if (s == c) return true;
+            if (s == last) return false;
+          }
+        };
+
+        // Either end of the segment may be joined to the candidate; gather both tour edges at each candidate
+        Kernels::Gain best{0, 0};
+        uint32_t best_c = 0, best_d = 0, best_joined = 0;
+        for (const uint32_t& joined : {first, last}) {
+          const uint32_t other = joined == first ? last : first;
+          const uint32_t* near = candidates.of(joined);
+          size_t count = 0;
+          for (size_t q = 0; q < candidates.k; q++) {
+            const uint32_t c = near[q];
+            if (inSegment(c)) continue;
+            for (const uint32_t& d : {tour.succ(c), tour.pred(c)}) {
+              if (inSegment(d)) continue;
+              cs[count] = c;
+              ds[count] = d;
+              count++;
+            }
+          }
+          Kernels::Gain found = Kernels::bestGain(cities, joined, other, cs.data(), ds.data(), count, removed);
+          if (found.index < count && found.gain > best.gain) {
+            best = found;
+            best_c = cs[found.index];
+            best_d = ds[found.index];
+            best_joined = joined;
+          }
+        }
+        if (best.gain <= 0) continue;
+
+        tour.moveSegment(first, length, best_c, best_d, best_joined);
+        touch(p); touch(next); touch(last); touch(best_c); touch(best_d);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /**
+   * The candidate-list local search for directed distances. Its moves keep every city's successor-side
+   * orientation: Or-opt moves a segment of up to 3 cities forward between two adjacent cities, and or-3opt
+   * swaps two adjacent paths [b..c] & [d..e] following city a, so no path is ever traversed backwards.
+   * Candidate lists hold the nearest cities by outgoing distance, so every candidate is tried as the head
+   * of a new edge leaving the city being improved.
+   */
+  class DirectedSearch {
+  public:
+    DirectedSearch(const TSP::CitySet& cities_, const TSP::Candidates& candidates_, std::vector<uint32_t> order)
+      : cities{cities_}, candidates{candidates_}, tour(std::move(order)), n{cities_.size()}, queued(n, true) {
+      for (const uint32_t& c : tour.order) queue.push_back(c);
+    }
+
+    std::vector<uint32_t> run() {
+      while (!queue.empty()) {
+        const uint32_t a = queue.front();
+        queue.pop_front();
+        queued[a] = false;
+        if (orThreeOpt(a) || orOpt(a)) touch(a);
+      }
+      return tour.order;
+    }
+
+  private:
+    const TSP::CitySet& cities;
+    const TSP::Candidates& candidates;
+    ArrayTour tour;
+    const size_t n;
+    std::deque<uint32_t> queue;
+    std::vector<bool> queued;
+
+    void touch(const uint32_t& c) {
+      if (!queued[c]) { queued[c] = true; queue.push_back(c); }
+    }
+
+    long long dist(const uint32_t& i, const uint32_t& j) const { return cities.distance(i, j); }
+
+    /**
+     * Replaces (a, b), (c, d) & (e, f) with (a, d), (e, b) & (c, f), where b follows a, d follows c, f follows
+     * e, and a, c, e appear in that order along the tour: the path [d..e] moves in front of [b..c].
+     */
+    bool orThreeOpt(const uint32_t& a) {
+      const uint32_t b = tour.succ(a);
+      const long long ab = dist(a, b);
+      long long best = 0;
+      uint32_t best_c = 0, best_e = 0;
+      for (size_t q = 0; q < candidates.k; q++) {
+        const uint32_t d = candidates.of(a)[q];
+        const long long g1 = ab - dist(a, d);
+        if (g1 <= 0) break;
+        const uint32_t c = tour.pred(d);
+        if (d == b) continue;
+        const long long g2 = g1 + dist(c, d);
+        const size_t reach_d = tour.ahead(a, d);
+        for (size_t r = 0; r < candidates.k; r++) {
+          const uint32_t f = candidates.of(c)[r];
+          const long long g3 = g2 - dist(c, f);
+          if (g3 <= 0) break;
+          const uint32_t e = tour.pred(f);
+          if (e == a || tour.ahead(a, e) < reach_d) continue;
+          const long long gain = g3 + dist(e, f) - dist(e, b);
+          if (gain > best) { best = gain; best_c = c; best_e = e; }
+        }
+      }
+      if (best <= 0) return false;
+
+      // Move whichever of the two paths is shorter
+      const uint32_t c = best_c, d = tour.succ(c), e = best_e, f = tour.succ(e);
+      const size_t bc = tour.ahead(b, c) + 1, de = tour.ahead(d, e) + 1;
+      if (de <= bc) tour.moveSegment(d, de, a, b, d);
+      else tour.moveSegment(b, bc, e, f, b);
+      touch(b); touch(c); touch(d); touch(e); touch(f);
+      return true;
+    }
+
+    bool orOpt(const uint32_t& first) {
+      if (n < 8) return false;
+      uint32_t last = first;
+      for (size_t length = 1; length <= 3; length++, last = tour.succ(last)) {
+        const uint32_t p = tour.pred(first), next = tour.succ(last);
+        const long long removed = dist(p, first) + dist(last, next) - dist(p, next);
+        if (removed <= 0) continue;
+
+        // The segment keeps its direction, so it is placed in front of a candidate d of its last city
+        long long best = 0;
+        uint32_t best_c = 0, best_d = 0;
+        for (size_t q = 0; q < candidates.k; q++) {
+          const uint32_t d = candidates.of(last)[q];
+          const uint32_t c = tour.pred(d);
+          if (tour.ahead(first, d) < length || tour.ahead(first, c) < length) continue;
+          const long long gain = removed - (dist(c, first) + dist(last, d) - dist(c, d));
+          if (gain > best) { best = gain; best_c = c; best_d = d; }
+        }
+        if (best <= 0) continue;
+
+        tour.moveSegment(first, length, best_c, best_d, first);
+        touch(p); touch(next); touch(last); touch(best_c); touch(best_d);
+        return true;
+      }
+      return false;
+    }
+  };
+}
+
+/**
+ * Improves a tour with 2-opt in parallel rounds. Each round finds the best exchange for every first edge
+ * concurrently, greedily selects a batch of improving exchanges with disjoint tour segments (largest gain
+ * first, ties broken by a seeded hash), reverses all of them in parallel, and repeats until none improve.
+ *
+ * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+ * @param threads The number of threads evaluating & applying exchanges.
+ * @param seed Chooses the order in which equal-gain exchanges are selected.
+ * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+ */
+TSP::Tour TSP::parallelTwoOpt(const Tour& tour, const size_t& threads, const uint64_t& seed) {
+  if (tour.path.size() < 5) return tour;
+  std::vector<Node> order(tour.path.begin(), tour.path.end() - 1);
+  const size_t n = order.size();
+  std::vector<Exchange> best(n - 2);
+
+  while (true) {
+    // Pair short & long scans so contiguous blocks of work are balanced
+    Parallel::parallelFor(0, (n - 1) / 2, [&](size_t t) {
+      best[t] = bestExchange(order, t);
+      if (n - 3 - t != t) best[n - 3 - t] = bestExchange(order, n - 3 - t);
+    }, threads);
+
+    std::vector<Exchange> improving;
+    for (Exchange& e : best) {
+      if (e.gain > 0) improving.push_back({e.gain, e.i, e.j, mix(seed ^ mix(e.i))});
+    }
+    if (improving.empty()) break;
+    std::sort(improving.begin(), improving.end(), [](const Exchange& l, const Exchange& r) {
+      return l.gain != r.gain ? l.gain > r.gain : l.rank < r.rank;
+    });
+
+    // Keep exchanges whose edge ranges [i, j] are disjoint from every exchange already kept
+    std::map<size_t, size_t> taken;
+    std::vector<Exchange> batch;
+    for (const Exchange& e : improving) {
+      auto next = taken.lower_bound(e.i);
+      if (next != taken.end() && next->first <= e.j) continue;
+      if (next != taken.begin() && std::prev(next)->second >= e.i) continue;
+      taken[e.i] = e.j;
+      batch.push_back(e);
+    }
+
+    Parallel::parallelFor(0, batch.size(), [&](size_t k) {
+      std::reverse(order.begin() + batch[k].i + 1, order.begin() + batch[k].j + 1);
+    }, threads);
+  }
+  return makeTour(order);
+}
+
+/**
+ * Re-optimizes a tour by sliding a window of k consecutive cities along its path & replacing each window
+ * with its optimal ordering between the two fixed cities just outside it (a Held-Karp path over the window).
+ * Windows in the same sweep do not overlap, so they are solved in parallel; sweeps alternate their offset by
+ * k / 2 until a full pair of sweeps finds no improvement.
+ *
+ * @param tour A closed tour from any constructor or improvement heuristic.
+ * @param k The number of cities per window; at most `HELD_KARP_MAX_CITIES` - 2.
+ * @param threads The number of threads solving windows.
+ * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+ */
+TSP::Tour TSP::windowOpt(const Tour& tour, const size_t& k, const size_t& threads) {
+  if (tour.path.size() < 4) return tour;
+  std::vector<Node> order(tour.path.begin(), tour.path.end() - 1);
+  const size_t n = order.size();
+
+  // The start city stays first, so windows cover positions 1..n-1 & may end at the closing edge
+  const size_t width = std::min({k, n - 1, HELD_KARP_MAX_CITIES - 2});
+  if (width < 2) return tour;
+  const size_t stride = width + 1;
+
+  size_t quiet_sweeps = 0;
+  for (size_t sweep = 0; quiet_sweeps < 2; sweep++) {
+    const size_t offset = 1 + (sweep % 2) * (width / 2);
+    const size_t windows = offset + width <= n ? (n - offset - width) / stride + 1 : 0;
+    std::atomic<size_t> improved{0};
+
+    // Neighboring windows share at most a fixed endpoint, so each writes a disjoint slice of `order`
+    Parallel::parallelFor(0, windows, [&](size_t w) {
+      const size_t first = offset + w * stride;
+      std::vector<Node> local;
+      local.reserve(width + 2);
+      local.push_back(order[first - 1]);
+      for (size_t i = first; i < first + width; i++) local.push_back(order[i]);
+      local.push_back(order[(first + width) % n]);
+
+      const size_t m = local.size();
+      std::vector<uint32_t> dist = distanceMatrix(local);
+      size_t before = 0;
+      for (size_t i = 0; i + 1 < m; i++) before += dist[i * m + i + 1];
+
+      std::vector<size_t> best = heldKarpPath(dist, m);
+      size_t after = 0;
+      for (size_t i = 0; i + 1 < m; i++) after += dist[best[i] * m + best[i+1]];
+      if (after >= before) return;
+
+      for (size_t i = 1; i + 1 < m; i++) order[first + i - 1] = local[best[i]];
+      improved++;
+    }, threads);
+
+    quiet_sweeps = improved ? 0 : quiet_sweeps + 1;
+  }
+  return makeTour(order);
+}
+
+/**
+ * Improves a tour with 2-opt & Or-opt (segments of up to 3 cities, either orientation) moves restricted to
+ * each city's K nearest candidates. Cities are processed from a queue of "dirty" cities (don't-look bits),
+ * and every batch of K candidate moves is scored in one pass by `Kernels::bestGain`.
+ *
+ * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+ * @param k The number of candidates per city.
+ * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+ */
+TSP::Tour TSP::localSearch(const Tour& tour, const size_t& k) {
+  if (tour.path.size() < 5) return tour;
+  std::vector<Node> nodes(tour.path.begin(), tour.path.end() - 1);
+  CitySet cities(nodes);
+  std::vector<uint32_t> order(nodes.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+
+  order = localSearch(cities, nearestCandidates(cities, k), order);
+  for (size_t i = 0; i < order.size(); i++) nodes[i] = cities.node(order[i]);
+  return makeTour(nodes);
+}
+
+/**
+ * Runs the same 2-opt & Or-opt local search as `localSearch(tour, k)` on a tour given as city indices.
+ * Asymmetric city sets are handed to `directedSearch` instead, since 2-opt reverses paths.
+ *
+ * @param cities The city set the indices refer to.
+ * @param candidates Candidate lists for `cities`.
+ * @param order Every index of `cities` once, in tour order.
+ * @return The improved order, starting with the same city.
+ */
+std::vector<uint32_t> TSP::localSearch(const CitySet& cities, const Candidates& candidates, std::vector<uint32_t> order) {
+  if (!cities.symmetric()) return directedSearch(cities, candidates, std::move(order));
+  if (order.size() < 5 || candidates.k == 0) return order;
+  const uint32_t start = order.front();
+  order = CandidateSearch(cities, candidates, std::move(order)).run();
+  std::rotate(order.begin(), std::find(order.begin(), order.end(), start), order.end());
+  return order;
+}
+
+/**
+ * Improves a tour of a possibly asymmetric city set with Or-opt & or-3opt moves (Or-2h style) restricted
+ * to each city's candidates, processing cities from a queue of "dirty" cities. No move reverses a path, so
+ * the gain of every move is exact under directed distances.
+ *
+ * @param cities The city set the indices refer to; distances may differ by direction.
+ * @param candidates Candidate lists for `cities`, by outgoing distance.
+ * @param order Every index of `cities` once, in tour order.
+ * @return The improved order, starting with the same city.
+ */
+std::vector<uint32_t> TSP::directedSearch(const CitySet& cities, const Candidates& candidates,
+                                          std::vector<uint32_t> order) {
+  if (order.size() < 5 || candidates.k == 0) return order;
+  const uint32_t start = order.front();
+  order = DirectedSearch(cities, candidates, std::move(order)).run();
+  std::rotate(order.begin(), std::find(order.begin(), order.end(), start), order.end());
+  return order;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+
+#include "Node.hpp"
+#include "TSP.hpp"
+#include "CitySet.hpp"
+#include "Candidates.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  /**
+   * Improves a tour with the 2-opt heuristic: repeatedly removes two edges (a, b) & (c, d) and reconnects
+   * the tour as (a, c) & (b, d) by reversing the segment between them, until no exchange shortens the tour.
+   *
+   * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+   * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+   */
+  Tour twoOpt(const Tour& tour);
+
+  /**
+   * Improves a tour with 2-opt & Or-opt (segments of up to 3 cities, either orientation) moves restricted to
+   * each city's K nearest candidates. Cities are processed from a queue of "dirty" cities (don't-look bits),
+   * and every batch of K candidate moves is scored in one pass by `Kernels::bestGain`.
+   *
+   * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+   * @param k The number of candidates per city.
+   * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+   */
+  Tour localSearch(const Tour& tour, const size_t& k = 8);
+
+  /**
+   * Runs the same 2-opt & Or-opt local search as `localSearch(tour, k)` on a tour given as city indices.
+   * Asymmetric city sets are handed to `directedSearch` instead, since 2-opt reverses paths.
+   *
+   * @param cities The city set the indices refer to.
+   * @param candidates Candidate lists for `cities`.
+   * @param order Every index of `cities` once, in tour order.
+   * @return The improved order, starting with the same city.
+   */
+  std::vector<uint32_t> localSearch(const CitySet& cities, const Candidates& candidates, std::vector<uint32_t> order);
+
+  /**
+   * Improves a tour of a possibly asymmetric city set with Or-opt & or-3opt moves (Or-2h style) restricted
+   * to each city's candidates, processing cities from a queue of "dirty" cities. No move reverses a path, so
+   * the gain of every move is exact under directed distances.
+   *
+   * @details
+   * - Or-opt moves a segment of up to 3 cities, keeping its direction, in front of a candidate of its last
+   *   city.
+   * - or-3opt replaces (a, b), (c, d) & (e, f) with (a, d), (e, b) & (c, f) for d a candidate of a & f a
+   *   candidate of c, swapping the adjacent paths [b..c] & [d..e]; the shorter of the two is moved.
+   *
+   * @param cities The city set the indices refer to; distances may differ by direction.
+   * @param candidates Candidate lists for `cities`, by outgoing distance.
+   * @param order Every index of `cities` once, in tour order.
+   * @return The improved order, starting with the same city.
+   */
+  std::vector<uint32_t> directedSearch(const CitySet& cities, const Candidates& candidates,
+                                       std::vector<uint32_t> order);
+
+  /**
+   * Improves a tour with 2-opt in parallel rounds. Each round finds the best exchange for every first edge
+   * concurrently, greedily selects a batch of improving exchanges with disjoint tour segments (largest gain
+   * first, ties broken by a seeded hash), reverses all of them in parallel, and repeats until none improve.
+   *
+   * @param tour A closed tour such as the one returned by `nearestNeighbor`.
+   * @param threads The number of threads evaluating & applying exchanges.
+   * @param seed Chooses the order in which equal-gain exchanges are selected.
+   * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+   *
+   * @note The result depends only on `tour` & `seed`, never on `threads` or scheduling.
+   */
+  Tour parallelTwoOpt(const Tour& tour, const size_t& threads = Parallel::defaultThreads(), const uint64_t& seed = 0);
+
+  /**
+   * Re-optimizes a tour by sliding a window of k consecutive cities along its path & replacing each window
+   * with its optimal ordering between the two fixed cities just outside it (a Held-Karp path over the window).
+   * Windows in the same sweep do not overlap, so they are solved in parallel; sweeps alternate their offset by
+   * k / 2 until a full pair of sweeps finds no improvement.
+   *
+   * @param tour A closed tour from any constructor or improvement heuristic.
+   * @param k The number of cities per window; at most `HELD_KARP_MAX_CITIES` - 2.
+   * @param threads The number of threads solving windows.
+   * @return A `TSP::Tour` starting at the same city whose total distance is no greater than the input's.
+   */
+  Tour windowOpt(const Tour& tour, const size_t& k = 10, const size_t& threads = Parallel::defaultThreads());
+};
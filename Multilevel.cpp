@@ -0,0 +1,179 @@
+#include "Multilevel.hpp"
+#include "Candidates.hpp"
+#include "LocalSearch.hpp"
+#include "Popmusic.hpp"
+
+#include <algorithm>
+
+namespace {
+  constexpr uint32_t NONE = UINT32_MAX;
+
+  // Neighbors each city may propose to, & proposal rounds per coarsening step
+  constexpr size_t MATCH_K = 4;
+  constexpr size_t MATCH_ROUNDS = 3;
+
+  // Candidates per city for the local search of the coarsest level
+  constexpr size_t REFINE_K = 8;
+
+  // Cities per re-optimized subpath when refining a finer level
+  constexpr size_t REFINE_R = 50;
+
+  // Coarsening stops early once a step removes fewer than 1 / STALL of the cities
+  constexpr size_t STALL = 10;
+
+  /**
+   * One coarsening step: city c of `cities` merges `first[c]` & `second[c]` (or is `first[c]` alone when
+   * `second[c]` is NONE) of the finer level.
+   */
+  struct Level {
+    TSP::CitySet cities;
+    std::vector<uint32_t> first, second;
+  };
+
+  /**
+   * Matches close pairs by handshakes: every unmatched city proposes to its nearest unmatched candidate and
+   * mutual proposals are matched, for a few rounds. Each round is parallel and the result does not depend
+   * on the number of threads.
+   */
+  Level coarsen(const TSP::CitySet& fine, const size_t& threads) {
+    const size_t n = fine.size();
+    TSP::Candidates near = TSP::nearestCandidates(fine, MATCH_K, threads);
+    std::vector<uint32_t> match(n, NONE), propose(n, NONE);
+    for (size_t round = 0; round < MATCH_ROUNDS; round++) {
+      Parallel::parallelFor(0, n, [&](size_t i) {
+        propose[i] = NONE;
+        if (match[i] != NONE) return;
+        for (size_t q = 0; q < near.k && propose[i] == NONE; q++) {
+          if (match[near.of(i)[q]] == NONE) propose[i] = near.of(i)[q];
+        }
+      }, threads);
+      Parallel::parallelFor(0, n, [&](size_t i) {
+        if (propose[i] != NONE && propose[propose[i]] == i) match[i] = propose[i];
+      }, threads);
+    }
+
+    Level level;
+    for (uint32_t i = 0; i < n; i++) {
+      if (match[i] != NONE && match[i] < i) continue;
+      level.first.push_back(i);
+      level.second.push_back(match[i]);
+    }
+
+    const size_t m = level.first.size();
+    std::vector<Node> merged(m, Node(0, 0, 0));
+    Parallel::parallelFor(0, m, [&](size_t c) {
+      const uint32_t a = level.first[c], b = level.second[c];
+      if (b == NONE) merged[c] = Node(c + 1, fine.x(a), fine.y(a));
+      else merged[c] = Node(c + 1, (fine.x(a) + fine.x(b)) / 2, (fine.y(a) + fine.y(b)) / 2);
+    }, threads);
+    level.cities = TSP::CitySet(merged);
+    return level;
+  }
+
+  /**
+   * Expands a tour of `level.cities` into a tour of the finer level. Each pair is laid out so its city
+   * nearer the preceding coarse city comes first, which depends only on the coarse tour, so positions
+   * are known up front & every pair is placed in parallel.
+   *
+   * Cities of a pair, & unmatched cities next to one, get new neighbors & are marked in `fresh`; an unmatched
+   * city between two unmatched ones keeps the neighbors it had in the coarse tour.
+   */
+  std::vector<uint32_t> expand(const Level& level, const TSP::CitySet& fine, const std::vector<uint32_t>& order,
+                               std::vector<uint8_t>& fresh, const size_t& threads) {
+    const size_t m = order.size();
+    std::vector<size_t> offset(m + 1, 0);
+    for (size_t p = 0; p < m; p++) offset[p + 1] = offset[p] + (level.second[order[p]] == NONE ? 1 : 2);
+
+    std::vector<uint32_t> expanded(offset[m]);
+    fresh.assign(fine.size(), 0);
+    Parallel::parallelFor(0, m, [&](size_t p) {
+      const uint32_t c = order[p], a = level.first[c], b = level.second[c];
+      const uint32_t prev = order[(p + m - 1) % m];
+      if (b == NONE) {
+        expanded[offset[p]] = a;
+        fresh[a] = level.second[prev] != NONE || level.second[order[(p + 1) % m]] != NONE;
+        return;
+      }
+      fresh[a] = fresh[b] = 1;
+      const double px = level.cities.x(prev), py = level.cities.y(prev);
+      auto squared = [&](const uint32_t& i) {
+        const double dx = fine.x(i) - px, dy = fine.y(i) - py;
+        return dx * dx + dy * dy;
+      };
+      const bool swap = squared(b) < squared(a);
+      expanded[offset[p]] = swap ? b : a;
+      expanded[offset[p] + 1] = swap ? a : b;
+    }, threads);
+    return expanded;
+  }
+
+  /**
+   * Refines an expanded tour with `optimizeSubpaths`: disjoint subpaths are improved in parallel, and only
+   * those holding a city `expand` gave new neighbors, so each level costs about as much as the tour changed.
+   */
+  void refine(const TSP::CitySet& cities, std::vector<uint32_t>& order, std::vector<uint8_t>& fresh,
+              const size_t& threads) {
+    TSP::optimizeSubpaths(cities, order, REFINE_R, fresh, threads);
+  }
+}
+
+/**
+ * Constructs a tour for a large city set with a multilevel scheme. The set is repeatedly coarsened by
+ * matching each city with a close unmatched neighbor & merging the pair into its midpoint, the coarsest
+ * level is solved with `nearestNeighbor` & `localSearch`, and each finer level inherits the tour of the
+ * level above (every merged city expands into its pair) before `optimizeSubpaths` refines the subpaths
+ * around the cities that expansion gave new neighbors, disjoint subpaths in parallel.
+ *
+ * @param cities The city set to visit.
+ * @param coarsest Coarsening stops once a level has at most this many cities.
+ * @param threads The number of threads matching cities, building candidate lists, expanding & refining tours.
+ * @return Every index of `cities` once, in tour order, starting with index 0.
+ */
+std::vector<uint32_t> TSP::multilevel(const CitySet& cities, const size_t& coarsest, const size_t& threads) {
+  const size_t n = cities.size();
+  if (n == 0) return {};
+
+  std::vector<Level> levels;
+  auto finer = [&](const size_t& l) -> const CitySet& { return l == 0 ? cities : levels[l - 1].cities; };
+  while (finer(levels.size()).size() > std::max<size_t>(coarsest, 3)) {
+    const CitySet& fine = finer(levels.size());
+    Level level = coarsen(fine, threads);
+    if (fine.size() - level.cities.size() < fine.size() / STALL) break;
+    levels.push_back(std::move(level));
+  }
+
+  // Solve the coarsest level from scratch
+  const CitySet& top = finer(levels.size());
+  std::list<Node> nodes;
+  for (size_t i = 0; i < top.size(); i++) nodes.push_back(Node(i + 1, top.x(i), top.y(i)));
+  Tour start = nearestNeighbor(nodes, 1);
+  std::vector<uint32_t> order;
+  order.reserve(top.size());
+  for (size_t i = 0; i + 1 < start.path.size(); i++) order.push_back(start.path[i].id - 1);
+  if (top.size() > 3) order = localSearch(top, nearestCandidates(top, REFINE_K, threads), std::move(order));
+
+  std::vector<uint8_t> fresh;
+  for (size_t l = levels.size(); l-- > 0;) {
+    order = expand(levels[l], finer(l), order, fresh, threads);
+    refine(finer(l), order, fresh, threads);
+  }
+
+  std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+  return order;
+}
+
+/**
+ * Constructs a tour with `multilevel` over the given cities.
+ *
+ * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+ * @param coarsest Coarsening stops once a level has at most this many cities.
+ * @param threads The number of threads matching cities, building candidate lists, expanding & refining tours.
+ * @return A `TSP::Tour` object representing the path, edge weights, and total distance of the computed tour.
+ */
+TSP::Tour TSP::multilevel(const std::vector<Node>& cities, const size_t& coarsest, const size_t& threads) {
+  std::vector<uint32_t> order = multilevel(CitySet(cities), coarsest, threads);
+  std::vector<Node> path;
+  path.reserve(order.size());
+  for (const uint32_t& i : order) path.push_back(cities[i]);
+  return makeTour(path);
+}
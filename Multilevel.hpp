@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Node.hpp"
+#include "TSP.hpp"
+#include "CitySet.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  /**
+   * Constructs a tour for a large city set with a multilevel scheme. The set is repeatedly coarsened by
+   * matching each city with a close unmatched neighbor & merging the pair into its midpoint, the coarsest
+   * level is solved with `nearestNeighbor` & `localSearch`, and each finer level inherits the tour of the
+   * level above (every merged city expands into its pair) before `optimizeSubpaths` refines the subpaths
+   * around the cities that expansion gave new neighbors, disjoint subpaths in parallel.
+   *
+   * @param cities The city set to visit.
+   * @param coarsest Coarsening stops once a level has at most this many cities.
+   * @param threads The number of threads matching cities, building candidate lists, expanding & refining tours.
+   * @return Every index of `cities` once, in tour order, starting with index 0.
+   */
+  std::vector<uint32_t> multilevel(const CitySet& cities, const size_t& coarsest = 1000,
+                                   const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Constructs a tour with `multilevel` over the given cities.
+   *
+   * @param cities The cities to be visited; the tour starts & ends at `cities.front()`.
+   * @param coarsest Coarsening stops once a level has at most this many cities.
+   * @param threads The number of threads matching cities, building candidate lists, expanding & refining tours.
+   * @return A `TSP::Tour` object representing the path, edge weights, and total distance of the computed tour.
+   */
+  Tour multilevel(const std::vector<Node>& cities, const size_t& coarsest = 1000,
+                  const size_t& threads = Parallel::defaultThreads());
+};
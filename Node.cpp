@@ -1,5 +1,6 @@
 #include "Node.hpp"
 #include <iostream>
+#include <limits>
 
 /**
  * Constructs a node with a non-negative identifier and 2D coordinates.
@@ -21,4 +22,40 @@ size_t Node::distance(const Node& other) const {
     double dx = (x - other.x);
     double dy = (y - other.y);
     return std::round(sqrt(dx * dx + dy * dy));
+}
+
+/**
+ * Calculates the squared Euclidean distance to another node, without rounding.
+ * `distance` is a non-decreasing function of this value, so it orders candidates without a square root.
+ *
+ * @param other The node to calculate the squared distance to.
+ * @return The squared distance.
+ */
+double Node::squaredDistance(const Node& other) const {
+    double dx = (x - other.x);
+    double dy = (y - other.y);
+    return dx * dx + dy * dy;
+}
+
+/**
+ * Determines whether `distance(other) < bound` from the squared distance alone, computing the rounded
+ * distance only when the squared distance lies within floating-point error of the rounding boundary.
+ *
+ * @param other The node to compare against.
+ * @param bound The rounded distance to beat.
+ * @return True exactly when `distance(other) < bound`.
+ */
+bool Node::closerThan(const Node& other, const size_t& bound) const {
+    if (bound == 0) return false;
+    // round(sqrt(s)) < bound  <=>  sqrt(s) < bound - 0.5, where s is the same double `distance` takes the root of.
+    // Only two roundings separate the comparison of s with edge from that one: sqrt(s) may round onto bound - 0.5
+    // when it lies within half an ulp of it (a relative 2^-53 of the root, so 2^-52 of s), and edge itself is
+    // (bound - 0.5)^2 rounded to a relative 2^-53. Outside a relative 4 * epsilon = 2^-50 of edge neither can
+    // change the answer; inside it, the rounded distance decides.
+    const double edge = (bound - 0.5) * (bound - 0.5);
+    const double margin = edge * 4 * std::numeric_limits<double>::epsilon();
+    const double squared = squaredDistance(other);
+    if (squared < edge - margin) return true;
+    if (squared > edge + margin) return false;
+    return distance(other) < bound;
 }
\ No newline at end of file
@@ -20,4 +20,23 @@ struct Node {
    * @return The distance as an integer.
    */
   size_t distance(const Node& other) const;
+
+  /**
+   * Calculates the squared Euclidean distance to another node, without rounding.
+   * `distance` is a non-decreasing function of this value, so it orders candidates without a square root.
+   *
+   * @param other The node to calculate the squared distance to.
+   * @return The squared distance.
+   */
+  double squaredDistance(const Node& other) const;
+
+  /**
+   * Determines whether `distance(other) < bound` from the squared distance alone, computing the rounded
+   * distance only when the squared distance lies within floating-point error of the rounding boundary.
+   *
+   * @param other The node to compare against.
+   * @param bound The rounded distance to beat.
+   * @return True exactly when `distance(other) < bound`.
+   */
+  bool closerThan(const Node& other, const size_t& bound) const;
 };
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+  // Tasks one deque holds; a thread whose deque is full runs the rest of its range itself
+  constexpr int64_t DEQUE_SLOTS = 1024;
+
+  // Deques never exceed this: one per pool worker & one per outside thread that has started a loop
+  constexpr size_t MAX_DEQUES = 1024;
+
+  // Blocks per thread when the caller leaves the block size to `grainSize`
+  constexpr size_t BLOCKS_PER_THREAD = 8;
+
+  // Sweeps over the deques that find nothing to steal before an idle worker parks
+  constexpr size_t IDLE_SWEEPS = 64;
+
+  // One call of `parallelBlocks`, on the stack of the thread that made it
+  struct Loop {
+    const std::function<void(size_t, size_t)>& body;
+    const size_t begin, end, step;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+
+    Loop(const std::function<void(size_t, size_t)>& body, const size_t& begin, const size_t& end,
+         const size_t& step, const size_t& blocks)
+        : body{body}, begin{begin}, end{end}, step{step}, remaining{blocks}, failed{false}, error{} {};
+  };
+
+  // Blocks [lo, hi) of a loop; pool workers numbered below `limit` may steal it
+  struct Task {
+    Loop* loop;
+    size_t lo, hi, limit;
+  };
+
+  /**
+   * A Chase-Lev work-stealing deque with the memory orders of Le, Pop, Cohen & Zappa Nardelli (2013): the
+   * owning thread pushes & pops at the bottom, thieves take from the top, & only taking the last task or
+   * stealing needs a compare-and-swap. The buffer has a fixed size, so `push` can fail.
+   */
+  class Deque {
+  public:
+    bool push(const Task& task) {
+      const int64_t b = bottom.load(std::memory_order_relaxed);
+      if (b - top.load(std::memory_order_acquire) >= DEQUE_SLOTS) return false;
+      slots[b % DEQUE_SLOTS].store(task);
+      bottom.store(b + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(Task& task) {
+      const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+      bottom.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t t = top.load(std::memory_order_relaxed);
+      if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+      }
+      task = slots[b % DEQUE_SLOTS].load();
+      if (t < b) return true;
+
+      // The last task: a thief may be taking it at the same time
+      const bool taken = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return taken;
+    }
+
+    // Takes the top task if `accept` agrees to it; the task read may be stale until the swap succeeds, so
+    // `accept` must only compare its fields
+    template <typename Accept>
+    bool steal(Task& task, const Accept& accept) {
+      int64_t t = top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const int64_t b = bottom.load(std::memory_order_acquire);
+      if (t >= b) return false;
+      task = slots[t % DEQUE_SLOTS].load();
+      if (!accept(task)) return false;
+      return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    int64_t end() const {
+      return bottom.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Slot {
+      std::atomic<Loop*> loop;
+      std::atomic<size_t> lo, hi, limit;
+
+      void store(const Task& task) {
+        loop.store(task.loop, std::memory_order_relaxed);
+        lo.store(task.lo, std::memory_order_relaxed);
+        hi.store(task.hi, std::memory_order_relaxed);
+        limit.store(task.limit, std::memory_order_relaxed);
+      }
+
+      Task load() const {
+        return {loop.load(std::memory_order_relaxed), lo.load(std::memory_order_relaxed),
+                hi.load(std::memory_order_relaxed), limit.load(std::memory_order_relaxed)};
+      }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    Slot slots[DEQUE_SLOTS];
+  };
+
+  // The deque of the current thread, & its 1-based worker number (0 outside the pool)
+  thread_local Deque* local = nullptr;
+  thread_local size_t rank = 0;
+
+  /**
+   * Runs the blocks of a task, first pushing the upper half of its range until a single block is left so
+   * other threads can steal the rest. After a block throws, the loop's remaining blocks are only counted.
+   */
+  void runTask(Task task, Deque& deque) {
+    while (task.hi - task.lo > 1) {
+      const size_t middle = task.lo + (task.hi - task.lo) / 2;
+      if (!deque.push({task.loop, middle, task.hi, task.limit})) break;
+      task.hi = middle;
+    }
+    Loop& loop = *task.loop;
+    for (size_t block = task.lo; block < task.hi; block++) {
+      if (!loop.failed.load(std::memory_order_relaxed)) {
+        try {
+          const size_t lo = loop.begin + block * loop.step;
+          loop.body(lo, lo + std::min(loop.step, loop.end - lo));
+        } catch (...) {
+          if (!loop.failed.exchange(true)) loop.error = std::current_exception();
+        }
+      }
+      // The caller may return as soon as the last block is counted, so `loop` is not touched after
+      loop.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  /**
+   * The process-wide pool: worker threads & the registry of every deque they may steal from.
+   */
+  class Pool {
+  public:
+    static Pool& instance() {
+      static Pool pool;
+      return pool;
+    }
+
+    ~Pool() {
+      stopping = true;
+      wake();
+      for (std::thread& worker : workers) worker.join();
+    }
+
+    // Starts workers until there are at least `wanted`
+    void grow(const size_t& wanted) {
+      if (started.load(std::memory_order_acquire) >= wanted) return;
+      std::lock_guard<std::mutex> guard(lock);
+      while (workers.size() < std::min(wanted, MAX_DEQUES / 2)) {
+        Deque& deque = add();
+        workers.emplace_back(&Pool::work, this, workers.size() + 1, &deque);
+      }
+      started.store(workers.size(), std::memory_order_release);
+    }
+
+    // The calling thread's deque; threads outside the pool lease one until they exit
+    Deque& deque() {
+      if (local) return *local;
+      struct Lease {
+        Deque* deque = nullptr;
+        ~Lease() {
+          if (!deque) return;
+          Pool& pool = Pool::instance();
+          std::lock_guard<std::mutex> guard(pool.lock);
+          pool.spare.push_back(deque);
+        }
+      };
+      thread_local Lease lease;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (spare.empty()) {
+          local = &add();
+        } else {
+          local = spare.back();
+          spare.pop_back();
+        }
+      }
+      lease.deque = local;
+      return *local;
+    }
+
+    // Wakes parked workers to look for a loop that just started
+    void wake() {
+      epoch.fetch_add(1);
+      if (sleepers.load() == 0) return;
+      { std::lock_guard<std::mutex> guard(lock); }
+      parked.notify_all();
+    }
+
+    // Steals a task `accept` agrees to from any deque but `self`, starting at a random one
+    template <typename Accept>
+    bool steal(Task& task, const Deque* self, const Accept& accept) {
+      thread_local uint64_t seed = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      const size_t n = count.load(std::memory_order_acquire);
+      for (size_t k = 0, first = seed % n; k < n; k++) {
+        Deque* victim = deques[(first + k) % n].load(std::memory_order_acquire);
+        if (victim != self && victim->steal(task, accept)) return true;
+      }
+      return false;
+    }
+
+  private:
+    std::mutex lock;
+    std::condition_variable parked;
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<size_t> sleepers{0}, started{0}, count{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<Deque*> deques[MAX_DEQUES];
+    std::vector<std::unique_ptr<Deque>> owned;
+    std::vector<Deque*> spare;
+    std::vector<std::thread> workers;
+
+    Pool() = default;
+
+    // Registers a new deque; the caller holds `lock`
+    Deque& add() {
+      const size_t n = count.load(std::memory_order_relaxed);
+      if (n == MAX_DEQUES) throw std::runtime_error("Too many threads share the thread pool.");
+      owned.push_back(std::make_unique<Deque>());
+      deques[n].store(owned.back().get(), std::memory_order_release);
+      count.store(n + 1, std::memory_order_release);
+      return *owned.back();
+    }
+
+    // A worker steals tasks its number allows, runs them & what they push, & parks after a few idle sweeps
+    void work(const size_t number, Deque* deque) {
+      local = deque;
+      rank = number;
+      const auto allowed = [&](const Task& task) { return task.limit > rank; };
+      uint64_t seen = epoch.load();
+      size_t idle = 0;
+      while (!stopping.load(std::memory_order_relaxed)) {
+        Task task;
+        if (steal(task, deque, allowed)) {
+          runTask(task, *deque);
+          while (deque->pop(task)) runTask(task, *deque);
+          idle = 0;
+          seen = epoch.load();
+        } else if (++idle < IDLE_SWEEPS) {
+          std::this_thread::yield();
+        } else {
+          std::unique_lock<std::mutex> guard(lock);
+          sleepers++;
+          parked.wait(guard, [&]() { return stopping.load() || epoch.load() != seen; });
+          sleepers--;
+          idle = 0;
+          seen = epoch.load();
+        }
+      }
+    }
+  };
+}
+
+/**
+ * The number of worker threads parallel algorithms use by default: one per hardware thread.
+ */
+size_t Parallel::defaultThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Picks the number of indices per block of a loop.
+ *
+ * @param count The number of indices in the loop.
+ * @param threads The number of threads sharing the loop.
+ * @param grain The block size the caller asked for, if not 0.
+ * @return `grain`, or the block size that cuts the loop into about 8 blocks per thread.
+ */
+size_t Parallel::grainSize(const size_t& count, const size_t& threads, const size_t& grain) {
+  if (grain > 0) return grain;
+  const size_t blocks = std::max<size_t>(threads, 1) * BLOCKS_PER_THREAD;
+  return std::max<size_t>(1, (count + blocks - 1) / blocks);
+}
+
+/**
+ * Runs `body(lo, hi)` over consecutive blocks of [begin, end) on the shared work-stealing pool. The calling
+ * thread runs blocks too, & while it waits it only steals blocks of this loop.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param body The work to run for each block.
+ * @param threads The number of threads to use, the caller included; 1 runs the loop on the calling thread.
+ * @param grain The number of indices per block; 0 picks one with `grainSize`.
+ * @throws The first exception a block throws, once every block has finished or been skipped.
+ */
+void Parallel::parallelBlocks(const size_t& begin, const size_t& end,
+                              const std::function<void(size_t, size_t)>& body, const size_t& threads,
+                              const size_t& grain) {
+  if (end <= begin) return;
+  const size_t count = end - begin;
+  const size_t step = grainSize(count, threads, grain);
+  const size_t blocks = (count - 1) / step + 1;
+  if (threads <= 1 || blocks == 1) {
+    for (size_t block = 0; block < blocks; block++) {
+      const size_t lo = begin + block * step;
+      body(lo, lo + std::min(step, end - lo));
+    }
+    return;
+  }
+
+  Pool& pool = Pool::instance();
+  pool.grow(threads - 1);
+  Deque& deque = pool.deque();
+  Loop loop(body, begin, end, step, blocks);
+  const int64_t mark = deque.end();
+  pool.wake();
+  runTask({&loop, 0, blocks, threads}, deque);
+
+  // Tasks above `mark` belong to this loop; tasks below it to loops this thread is already running a block of
+  const auto own = [&](const Task& task) { return task.loop == &loop; };
+  Task task;
+  while (loop.remaining.load(std::memory_order_acquire) > 0) {
+    if ((deque.end() > mark && deque.pop(task)) || pool.steal(task, &deque, own)) runTask(task, deque);
+    else std::this_thread::yield();
+  }
+  if (loop.error) std::rethrow_exception(loop.error);
+}
+
+/**
+ * Runs `body(i)` for every i in [begin, end) with `parallelBlocks`.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param body The work to run for each index.
+ * @param threads The number of threads to use, the caller included; 1 runs the loop on the calling thread.
+ * @param grain The number of indices per block; 0 picks one with `grainSize`.
+ * @throws The first exception `body` throws.
+ */
+void Parallel::parallelFor(const size_t& begin, const size_t& end, const std::function<void(size_t)>& body,
+                           const size_t& threads, const size_t& grain) {
+  parallelBlocks(begin, end, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) body(i);
+  }, threads, grain);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+  /**
+   * The number of worker threads parallel algorithms use by default: one per hardware thread.
+   */
+  size_t defaultThreads();
+
+  /**
+   * @param count The number of indices in a loop.
+   * @param threads The number of threads sharing the loop.
+   * @param grain The number of indices per block the caller asked for; 0 picks one.
+   * @return `grain` if it is set, otherwise the block size that gives every thread about 8 blocks, so threads
+   *         that finish early have blocks left to steal from slower ones.
+   */
+  size_t grainSize(const size_t& count, const size_t& threads, const size_t& grain = 0);
+
+  /**
+   * Runs `body(lo, hi)` over [begin, end) cut into consecutive blocks of `grainSize(end - begin, threads,
+   * grain)` indices (the last one may be shorter) on the shared work-stealing pool. Returns once every block
+   * has finished; blocks must not write to shared state.
+   *
+   * @details
+   * The pool keeps one Chase-Lev deque per thread. A thread running a range of blocks pushes its upper half
+   * & keeps splitting the lower one until a single block is left, so idle threads steal the largest ranges
+   * first, from the top of the deque, while the owner works through its own from the bottom. Workers park
+   * on a condition variable after a few empty sweeps & are woken when a loop starts. The calling thread
+   * runs blocks too, and while it waits it only takes blocks of its own loop, so a block may itself start a
+   * nested loop. The pool starts on first use & grows when a loop asks for more threads than it has.
+   *
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param body The work to run for each block.
+   * @param threads The number of threads to use, the caller included; 1 runs the loop on the calling thread.
+   * @param grain The number of indices per block; 0 picks one with `grainSize`.
+   * @throws Whatever a block throws: the first exception is rethrown on the calling thread once the blocks
+   *         still running have finished, and blocks that have not started yet are skipped.
+   */
+  void parallelBlocks(const size_t& begin, const size_t& end, const std::function<void(size_t, size_t)>& body,
+                      const size_t& threads = defaultThreads(), const size_t& grain = 0);
+
+  /**
+   * Runs `body(i)` for every i in [begin, end) with `parallelBlocks`. Returns once every call has finished;
+   * calls for different i must not write to shared state.
+   *
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param body The work to run for each index.
+   * @param threads The number of threads to use, the caller included; 1 runs the loop on the calling thread.
+   * @param grain The number of indices per block; 0 picks one with `grainSize`.
+   * @throws Whatever `body` throws, as `parallelBlocks` does.
+   */
+  void parallelFor(const size_t& begin, const size_t& end, const std::function<void(size_t)>& body,
+                   const size_t& threads = defaultThreads(), const size_t& grain = 0);
+
+  /**
+   * Folds `map(i)` for every i in [begin, end) into one value with `combine`. Each block of `parallelBlocks`
+   * folds its indices in order into its own partial, and the partials are then folded in block order, so for
+   * a given block size the result does not depend on which threads ran which blocks.
+   *
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param identity The value `combine` leaves unchanged, which starts every partial.
+   * @param map The value of one index.
+   * @param combine Joins two values; must be associative.
+   * @param threads The number of threads to use, the caller included.
+   * @param grain The number of indices per block; 0 picks one with `grainSize`.
+   * @return The fold of every `map(i)`, or `identity` for an empty range.
+   */
+  template <typename T, typename Map, typename Combine>
+  T parallelReduce(const size_t& begin, const size_t& end, const T& identity, const Map& map,
+                   const Combine& combine, const size_t& threads = defaultThreads(), const size_t& grain = 0) {
+    if (end <= begin) return identity;
+    const size_t step = grainSize(end - begin, threads, grain);
+    std::vector<T> partials((end - begin + step - 1) / step, identity);
+    parallelBlocks(begin, end, [&](size_t lo, size_t hi) {
+      T& partial = partials[(lo - begin) / step];
+      for (size_t i = lo; i < hi; i++) partial = combine(partial, map(i));
+    }, threads, step);
+
+    T total = identity;
+    for (const T& partial : partials) total = combine(total, partial);
+    return total;
+  }
+};
@@ -0,0 +1,246 @@
+#include "Popmusic.hpp"
+#include "Kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+  // Bits per axis of the Hilbert curve grid
+  constexpr unsigned HILBERT_BITS = 16;
+
+  // Sweeps per POPMUSIC tour never exceed this, even if subpaths keep improving
+  constexpr size_t MAX_SWEEPS = 32;
+
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // The position of grid cell (x, y) along a Hilbert curve over a 2^HILBERT_BITS square
+  uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << (HILBERT_BITS - 1); s > 0; s >>= 1) {
+      const uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+      d += uint64_t(s) * s * ((3 * rx) ^ ry);
+      if (ry == 0) {
+        if (rx == 1) { x = s - 1 - (x & (s - 1)); y = s - 1 - (y & (s - 1)); }
+        std::swap(x, y);
+      }
+      x &= s - 1;
+      y &= s - 1;
+    }
+    return d;
+  }
+
+  /**
+   * Improves the path p[0..m) with 2-opt & Or-opt (segments of up to 3 cities, either orientation) moves that
+   * keep p[0] & p[m - 1] in place. Each pass applies every improving move it meets; passes repeat until one
+   * finds none.
+   *
+   * @return Whether the path got shorter.
+   */
+  bool optimizePath(const TSP::CitySet& cities, std::vector<uint32_t>& path) {
+    // Work on positions of the original path so distances come from a small dense matrix
+    const size_t m = path.size();
+    thread_local std::vector<long long> dist;
+    thread_local std::vector<double> row;
+    thread_local std::vector<uint32_t> p, moved;
+    dist.resize(m * m);
+    row.resize(m);
+    for (size_t a = 0; a < m; a++) {
+      Kernels::distances(cities, path[a], path.data() + a, m - a, row.data());
+      for (size_t b = a; b < m; b++) dist[a * m + b] = dist[b * m + a] = (long long)row[b - a];
+    }
+    p.resize(m);
+    for (size_t a = 0; a < m; a++) p[a] = a;
+    auto d = [&](const size_t& a, const size_t& b) { return dist[p[a] * m + p[b]]; };
+    bool improved = false, changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t i = 1; i + 2 < m; i++) {
+        for (size_t j = i + 1; j + 1 < m; j++) {
+          if (d(i - 1, i) + d(j, j + 1) > d(i - 1, j) + d(i, j + 1)) {
+            std::reverse(p.begin() + i, p.begin() + j + 1);
+            changed = true;
+          }
+        }
+      }
+      for (size_t length = 1; length <= 3; length++) {
+        for (size_t i = 1; i + length < m; i++) {
+          const size_t last = i + length - 1;
+          const long long removed = d(i - 1, i) + d(last, last + 1) - d(i - 1, last + 1);
+          for (size_t j = 0; j + 1 < m; j++) {
+            if (j + 1 >= i && j <= last) continue;
+            const long long kept = d(j, i) + d(last, j + 1), flipped = d(j, last) + d(i, j + 1);
+            const long long added = std::min(kept, flipped) - d(j, j + 1);
+            if (added >= removed) continue;
+
+            moved.assign(p.begin() + i, p.begin() + last + 1);
+            if (flipped < kept) std::reverse(moved.begin(), moved.end());
+            p.erase(p.begin() + i, p.begin() + last + 1);
+            const size_t at = j < i ? j + 1 : j + 1 - length;
+            p.insert(p.begin() + at, moved.begin(), moved.end());
+            changed = true;
+            break;
+          }
+        }
+      }
+      improved = improved || changed;
+    }
+    if (!improved) return false;
+    for (uint32_t& a : p) a = path[a];
+    path.swap(p);
+    return true;
+  }
+}
+
+/**
+ * Orders cities along a Hilbert curve over their bounding box, a tour roughly 25% longer than optimal
+ * on uniform instances that costs one sort to build.
+ *
+ * @param cities The cities to order.
+ * @param seed 0 for the plain curve; other values shift the cities cyclically within the box by a
+ *             pseudo-random offset first, which moves the curve's seams & gives a different tour.
+ * @param threads The number of threads computing curve positions.
+ * @return Every index of `cities` once, in curve order.
+ */
+std::vector<uint32_t> TSP::hilbertOrder(const CitySet& cities, const uint64_t& seed, const size_t& threads) {
+  const size_t n = cities.size();
+  if (n == 0) return {};
+  double min_x = cities.x(0), max_x = min_x, min_y = cities.y(0), max_y = min_y;
+  for (size_t i = 1; i < n; i++) {
+    min_x = std::min(min_x, cities.x(i)); max_x = std::max(max_x, cities.x(i));
+    min_y = std::min(min_y, cities.y(i)); max_y = std::max(max_y, cities.y(i));
+  }
+  const double side = std::max({max_x - min_x, max_y - min_y, 1e-9});
+  const double cells = double(1u << HILBERT_BITS);
+  const double shift_x = seed ? double(mix(seed) >> 11) / double(1ULL << 53) : 0;
+  const double shift_y = seed ? double(mix(seed ^ 1) >> 11) / double(1ULL << 53) : 0;
+
+  std::vector<std::pair<uint64_t, uint32_t>> keyed(n);
+  Parallel::parallelFor(0, n, [&](size_t i) {
+    auto cell = [&](const double& v, const double& low, const double& shift) {
+      double t = (v - low) / side + shift;
+      t -= std::floor(t);
+      return uint32_t(std::min(cells - 1, t * cells));
+    };
+    keyed[i] = {hilbertIndex(cell(cities.x(i), min_x, shift_x), cell(cities.y(i), min_y, shift_y)), uint32_t(i)};
+  }, threads);
+  std::sort(keyed.begin(), keyed.end());
+
+  std::vector<uint32_t> order(n);
+  for (size_t i = 0; i < n; i++) order[i] = keyed[i].second;
+  return order;
+}
+
+/**
+ * Re-optimizes subpaths of r cities with `optimizePath`. Subpaths in a sweep are separated by one fixed
+ * city, so they are solved in parallel; the tour is rotated by r / 2 + 1 between sweeps so the seams move.
+ * As in POPMUSIC, a subpath is only optimized again once one of its cities has changed neighbors since it
+ * was last part of a subpath that could not be improved.
+ *
+ * @param cities The city set the indices refer to.
+ * @param order Every index of `cities` once, in tour order; improved in place & possibly rotated.
+ * @param r The number of cities in each re-optimized subpath.
+ * @param fresh One flag per city, set for the cities whose neighbors changed since the tour was last optimized;
+ *              cleared for cities of subpaths that could not be improved.
+ * @param threads The number of threads optimizing subpaths.
+ */
+void TSP::optimizeSubpaths(const CitySet& cities, std::vector<uint32_t>& order, const size_t& r,
+                           std::vector<uint8_t>& fresh, const size_t& threads) {
+  const size_t n = order.size();
+  const size_t width = std::min(r, n > 2 ? n - 2 : 0);
+  if (width < 2) return;
+  const size_t stride = width + 1;
+
+  size_t quiet_sweeps = 0;
+  for (size_t sweep = 0; quiet_sweeps < 2 && sweep < MAX_SWEEPS; sweep++) {
+    if (sweep > 0) std::rotate(order.begin(), order.begin() + width / 2 + 1, order.end());
+    const size_t windows = 1 + (n - 1 - width) / stride;
+    std::vector<uint8_t> improved(windows, 0);
+    Parallel::parallelFor(0, windows, [&](size_t w) {
+      thread_local std::vector<uint32_t> path;
+      const size_t first = 1 + w * stride;
+      bool stale = false;
+      for (size_t i = first - 1; i <= first + width && !stale; i++) stale = fresh[order[i % n]];
+      if (!stale) return;
+
+      path.assign(1, order[first - 1]);
+      for (size_t i = first; i < first + width; i++) path.push_back(order[i]);
+      path.push_back(order[(first + width) % n]);
+      improved[w] = optimizePath(cities, path);
+      for (size_t i = 1; i + 1 < path.size(); i++) {
+        order[first + i - 1] = path[i];
+        fresh[path[i]] = improved[w];
+      }
+    }, threads);
+
+    // The fixed ends of an improved subpath have new neighbors too; neighboring subpaths share them
+    size_t count = 0;
+    for (size_t w = 0; w < windows; w++) {
+      if (!improved[w]) continue;
+      count++;
+      fresh[order[w * stride]] = fresh[order[(w * stride + stride) % n]] = 1;
+    }
+    quiet_sweeps = count ? 0 : quiet_sweeps + 1;
+  }
+}
+
+/**
+ * Builds candidate lists from the edges of several POPMUSIC tours (Taillard & Helsgaun). Each tour starts
+ * from a differently shifted `hilbertOrder`; subpaths of r cities are then re-optimized with 2-opt & Or-opt
+ * between their fixed endpoints, non-overlapping subpaths in parallel, with the subpath boundaries moving
+ * every sweep until two sweeps in a row find nothing to improve.
+ *
+ * @param cities The cities to connect.
+ * @param k The number of candidates per city.
+ * @param tours The number of tours whose edges are collected.
+ * @param r The number of cities in each re-optimized subpath.
+ * @param threads The number of threads optimizing subpaths & building lists.
+ * @return The candidate lists, each ordered by increasing distance.
+ */
+TSP::Candidates TSP::popmusicCandidates(const CitySet& cities, const size_t& k, const size_t& tours,
+                                        const size_t& r, const size_t& threads) {
+  const size_t n = cities.size();
+  Candidates candidates = nearestCandidates(cities, k, threads);
+  if (candidates.k == 0 || tours == 0) return candidates;
+
+  // adjacent[i * 2 * tours + 2 * t ..] holds the two tour neighbors of city i in tour t
+  const size_t width = 2 * tours;
+  std::vector<uint32_t> adjacent(n * width);
+  for (size_t t = 0; t < tours; t++) {
+    std::vector<uint32_t> order = hilbertOrder(cities, t, threads);
+    std::vector<uint8_t> fresh(n, 1);
+    optimizeSubpaths(cities, order, r, fresh, threads);
+    Parallel::parallelFor(0, n, [&](size_t p) {
+      adjacent[order[p] * width + 2 * t] = order[(p + n - 1) % n];
+      adjacent[order[p] * width + 2 * t + 1] = order[(p + 1) % n];
+    }, threads);
+  }
+
+  Parallel::parallelFor(0, n, [&](size_t i) {
+    thread_local std::vector<uint32_t> merged;
+    const uint32_t* tour_edges = adjacent.data() + i * width;
+    merged.assign(tour_edges, tour_edges + width);
+    std::sort(merged.begin(), merged.end(), [&](const uint32_t& a, const uint32_t& b) {
+      const size_t da = cities.distance(i, a), db = cities.distance(i, b);
+      return da != db ? da < db : a < b;
+    });
+    merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+    merged.resize(std::min(merged.size(), candidates.k));
+
+    // Top up with the nearest cities the tours did not already supply
+    uint32_t* list = candidates.neighbors.data() + i * candidates.k;
+    for (size_t q = 0; q < candidates.k && merged.size() < candidates.k; q++) {
+      if (std::find(merged.begin(), merged.end(), list[q]) == merged.end()) merged.push_back(list[q]);
+    }
+    std::stable_sort(merged.begin(), merged.end(), [&](const uint32_t& a, const uint32_t& b) {
+      return cities.distance(i, a) < cities.distance(i, b);
+    });
+    std::copy(merged.begin(), merged.end(), list);
+  }, threads);
+  return candidates;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "CitySet.hpp"
+#include "Candidates.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  /**
+   * Orders cities along a Hilbert curve over their bounding box, a tour roughly 25% longer than optimal
+   * on uniform instances that costs one sort to build.
+   *
+   * @param cities The cities to order.
+   * @param seed 0 for the plain curve; other values shift the cities cyclically within the box by a
+   *             pseudo-random offset first, which moves the curve's seams & gives a different tour.
+   * @param threads The number of threads computing curve positions.
+   * @return Every index of `cities` once, in curve order.
+   */
+  std::vector<uint32_t> hilbertOrder(const CitySet& cities, const uint64_t& seed = 0,
+                                     const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Re-optimizes a tour POPMUSIC-style: subpaths of r cities are improved with 2-opt & Or-opt between their
+   * fixed endpoints, non-overlapping subpaths in parallel, with the subpath boundaries moving every sweep until
+   * two sweeps in a row find nothing to improve. Only subpaths holding a fresh city are optimized, so the work
+   * follows the part of the tour that changed.
+   *
+   * @param cities The city set the indices refer to.
+   * @param order Every index of `cities` once, in tour order; improved in place & possibly rotated.
+   * @param r The number of cities in each re-optimized subpath.
+   * @param fresh One flag per city, set for the cities whose neighbors changed since the tour was last optimized;
+   *              cleared for cities of subpaths that could not be improved.
+   * @param threads The number of threads optimizing subpaths.
+   */
+  void optimizeSubpaths(const CitySet& cities, std::vector<uint32_t>& order, const size_t& r,
+                        std::vector<uint8_t>& fresh, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Builds candidate lists from the edges of several POPMUSIC tours (Taillard & Helsgaun). Each tour starts
+   * from a differently shifted `hilbertOrder`; subpaths of r cities are then re-optimized with 2-opt & Or-opt
+   * between their fixed endpoints, non-overlapping subpaths in parallel, with the subpath boundaries moving
+   * every sweep until two sweeps in a row find nothing to improve.
+   *
+   * @details
+   * Every sweep costs O(n r) & the number of sweeps is capped, so the whole pass is O(n log n) for a fixed r.
+   * A city's candidates are its neighbors in any of the tours, nearest first, topped up with its nearest
+   * cities when the tours give it fewer than k.
+   *
+   * @param cities The cities to connect.
+   * @param k The number of candidates per city.
+   * @param tours The number of tours whose edges are collected.
+   * @param r The number of cities in each re-optimized subpath.
+   * @param threads The number of threads optimizing subpaths & building lists.
+   * @return The candidate lists, each ordered by increasing distance.
+   */
+  Candidates popmusicCandidates(const CitySet& cities, const size_t& k = 8, const size_t& tours = 5,
+                                const size_t& r = 50, const size_t& threads = Parallel::defaultThreads());
+};
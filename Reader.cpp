@@ -0,0 +1,707 @@
+#include "Reader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#if __has_include(<zlib.h>)
+#include <zlib.h>
+#define TSP_HAVE_ZLIB 1
+#endif
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define TSP_HAVE_ZSTD 1
+#endif
+
+namespace {
+  // Chunks per thread, so a chunk of long lines does not leave the other threads waiting
+  constexpr size_t CHUNKS_PER_THREAD = 4;
+
+  // Compressed files are decompressed in blocks of this size, with at most STREAM_BLOCKS of them in flight
+  constexpr size_t STREAM_BLOCK = size_t(1) << 20;
+  constexpr size_t STREAM_BLOCKS = 4;
+
+  // The stream parser reserves at most this many values from DIMENSION before reading them, so a bad header
+  // cannot ask for a huge allocation up front; longer sections grow the arrays as they are read
+  constexpr size_t MAX_RESERVE = size_t(1) << 24;
+
+  bool blank(const char& c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+  const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && blank(*p)) p++;
+    return p;
+  }
+
+  const char* lineEnd(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline : end;
+  }
+
+  std::string trim(const std::string& s) {
+    const size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+  }
+
+  // The header fields the reader needs
+  struct Header {
+    size_t dimension = 0;
+    std::string weight_type, weight_format;
+    bool explicit_weights = false;
+    size_t capacity = 0;
+  };
+
+  // Parses the whole value of a count header such as DIMENSION, naming the key if it is not one
+  size_t parseCount(const std::string& key, const std::string& value) {
+    size_t count = 0;
+    const char* end = value.data() + value.size();
+    std::from_chars_result result = std::from_chars(value.data(), end, count);
+    if (result.ec != std::errc() || result.ptr != end) {
+      throw std::runtime_error("TSP file's " + key + " is not a count: " + value + ".");
+    }
+    return count;
+  }
+
+  /**
+   * Reads one "KEY : VALUE" header line into `header`.
+   *
+   * @return Whether the line opens the NODE_COORD_SECTION or, setting `header.explicit_weights`, the
+   *         EDGE_WEIGHT_SECTION.
+   */
+  bool parseHeaderLine(const std::string& raw, Header& header) {
+    const std::string line = trim(raw);
+    if (line.rfind("NODE_COORD_SECTION", 0) == 0) return true;
+    if (line.rfind("EDGE_WEIGHT_SECTION", 0) == 0) return header.explicit_weights = true;
+
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) return false;
+    const std::string key = trim(line.substr(0, colon)), value = trim(line.substr(colon + 1));
+    if (key == "DIMENSION") header.dimension = parseCount(key, value);
+    if (header.dimension > UINT32_MAX) {
+      throw std::runtime_error("TSP file's DIMENSION exceeds the " + std::to_string(UINT32_MAX) +
+                               " cities a city set can index.");
+    }
+    if (key == "EDGE_WEIGHT_TYPE") header.weight_type = value;
+    if (key == "EDGE_WEIGHT_FORMAT") header.weight_format = value;
+    if (key == "CAPACITY") header.capacity = parseCount(key, value);
+    return false;
+  }
+
+  /**
+   * Reads header lines up to NODE_COORD_SECTION or EDGE_WEIGHT_SECTION.
+   *
+   * @return The offset of the first line after the section line.
+   */
+  size_t parseHeader(const std::string& text, Header& header) {
+    size_t at = 0;
+    while (at < text.size()) {
+      const size_t end = std::min(text.find('\n', at), text.size());
+      const bool section = parseHeaderLine(text.substr(at, end - at), header);
+      at = end + 1;
+      if (section) return std::min(at, text.size());
+    }
+    throw std::runtime_error("TSP file has no NODE_COORD_SECTION or EDGE_WEIGHT_SECTION.");
+  }
+
+  /**
+   * Counts the lines of [p, end) that hold anything but whitespace, stopping at a keyword line (EOF or the
+   * next section), whose start is stored in `keyword`.
+   */
+  size_t countLines(const char* p, const char* end, const char*& keyword) {
+    size_t count = 0;
+    keyword = nullptr;
+    while (p < end) {
+      const char* stop = lineEnd(p, end);
+      const char* first = skipBlanks(p, stop);
+      if (first < stop && std::isalpha(static_cast<unsigned char>(*first))) { keyword = p; break; }
+      if (first < stop) count++;
+      p = stop + 1;
+    }
+    return count;
+  }
+
+  // Counts the whitespace-separated values of [p, end) like `countLines`, stopping at a keyword line
+  size_t countValues(const char* p, const char* end, const char*& keyword) {
+    size_t count = 0;
+    keyword = nullptr;
+    while (p < end) {
+      const char* stop = lineEnd(p, end);
+      const char* first = skipBlanks(p, stop);
+      if (first < stop && std::isalpha(static_cast<unsigned char>(*first))) { keyword = p; break; }
+      for (const char* q = first; q < stop;) {
+        count++;
+        while (q < stop && !blank(*q)) q++;
+        q = skipBlanks(q, stop);
+      }
+      p = stop + 1;
+    }
+    return count;
+  }
+
+  // Parses one number after optional blanks; returns nullptr if there is none
+  template <typename T>
+  const char* parseField(const char* p, const char* end, T& value) {
+    if (!p) return nullptr;
+    p = skipBlanks(p, end);
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+  }
+
+  // Checks the parsed cities against DIMENSION & builds the id index, which finds repeated ids on the way
+  void validate(TSP::CitySet& cities, const Header& header) {
+    if (header.dimension != 0 && cities.size() != header.dimension) {
+      throw std::runtime_error("TSP file's coordinate count does not match its DIMENSION.");
+    }
+    if (!cities.indexIds()) throw std::runtime_error("TSP file repeats a city id.");
+  }
+
+  /**
+   * Reads the lines after the coordinates or weights, one at a time: the CVRP sections DEMAND_SECTION
+   * ("id demand" lines) & DEPOT_SECTION (ids up to -1), plus any late "KEY : VALUE" lines. Ids are only
+   * resolved by `finish`, once the cities are indexed.
+   */
+  class Trailer {
+  public:
+    void line(const char* p, const char* end, Header& header) {
+      const char* first = skipBlanks(p, end);
+      if (first == end) return;
+      if (std::isalpha(static_cast<unsigned char>(*first))) {
+        const std::string keyword = trim(std::string(first, end));
+        section = keyword.rfind("DEMAND_SECTION", 0) == 0 ? Section::DEMAND
+                : keyword.rfind("DEPOT_SECTION", 0) == 0 ? Section::DEPOT : Section::NONE;
+        if (section == Section::NONE) parseHeaderLine(keyword, header);
+        return;
+      }
+      if (section == Section::DEMAND) {
+        size_t id, demand;
+        malformed = malformed || !parseField(parseField(first, end, id), end, demand);
+        if (!malformed) demands.emplace_back(id, demand);
+      } else if (section == Section::DEPOT) {
+        long long id;
+        malformed = malformed || !parseField(first, end, id);
+        if (!malformed && id >= 0) depots.push_back(size_t(id));
+        if (!malformed && id < 0) section = Section::NONE;
+      }
+    }
+
+    void finish(TSP::CitySet& cities, const Header& header) const {
+      if (malformed) throw std::runtime_error("TSP file has a malformed DEMAND_SECTION or DEPOT_SECTION line.");
+      cities.capacity = header.capacity;
+      if (!demands.empty()) {
+        if (demands.size() != cities.size()) {
+          throw std::runtime_error("TSP file's DEMAND_SECTION does not list every city.");
+        }
+        cities.demands.assign(cities.size(), 0);
+        for (const std::pair<size_t, size_t>& demand : demands) {
+          cities.demands[cities.index(demand.first)] = demand.second;
+        }
+      }
+      for (const size_t& id : depots) cities.depots.push_back(uint32_t(cities.index(id)));
+    }
+
+  private:
+    enum class Section { NONE, DEMAND, DEPOT } section = Section::NONE;
+    std::vector<std::pair<size_t, size_t>> demands;
+    std::vector<size_t> depots;
+    bool malformed = false;
+  };
+
+  // Runs a `Trailer` over the rest of an in-memory file
+  void readTrailer(const char* p, const char* end, TSP::CitySet& cities, Header& header) {
+    Trailer trailer;
+    while (p < end) {
+      const char* stop = lineEnd(p, end);
+      trailer.line(p, stop, header);
+      p = stop + 1;
+    }
+    trailer.finish(cities, header);
+  }
+
+  /**
+   * Where row r of an EDGE_WEIGHT_FORMAT starts in the value stream & which columns it covers: row r lists
+   * (r, c) for c in [low, high). Column formats of a symmetric matrix list the same pairs as the transposed
+   * row formats, so they share a layout.
+   */
+  struct Layout {
+    bool full = false, diagonal = false, upper = false;
+
+    size_t offset(const size_t& r, const size_t& n) const {
+      if (full) return r * n;
+      if (upper) return diagonal ? r * n - r * (r - 1) / 2 : r * (n - 1) - r * (r - 1) / 2;
+      return diagonal ? r * (r + 1) / 2 : r * (r - 1) / 2;
+    }
+    size_t low(const size_t& r) const { return full || !upper ? 0 : (diagonal ? r : r + 1); }
+    size_t high(const size_t& r, const size_t& n) const { return full || upper ? n : (diagonal ? r + 1 : r); }
+  };
+
+  Layout layout(const std::string& format) {
+    if (format == "FULL_MATRIX") return {true, true, false};
+    if (format == "UPPER_ROW" || format == "LOWER_COL") return {false, false, true};
+    if (format == "UPPER_DIAG_ROW" || format == "LOWER_DIAG_COL") return {false, true, true};
+    if (format == "LOWER_ROW" || format == "UPPER_COL") return {false, false, false};
+    if (format == "LOWER_DIAG_ROW" || format == "UPPER_DIAG_COL") return {false, true, false};
+    throw std::runtime_error("Unsupported EDGE_WEIGHT_FORMAT: " + format + ".");
+  }
+
+  /**
+   * Turns the values of an EDGE_WEIGHT_SECTION into an `EXPLICIT` city set. LOWER_DIAG_ROW values already are
+   * the symmetric storage order & are kept as they are; other triangular formats are placed row by row in
+   * parallel, and FULL_MATRIX values are kept whole only if the matrix turns out to be asymmetric.
+   */
+  TSP::CitySet explicitCities(const Header& header, std::vector<uint32_t> values, const size_t& threads) {
+    if (header.weight_type != "EXPLICIT") {
+      throw std::runtime_error("TSP file has an EDGE_WEIGHT_SECTION but its EDGE_WEIGHT_TYPE is not EXPLICIT.");
+    }
+    const Layout shape = layout(header.weight_format);
+    const size_t n = header.dimension;
+    if (n == 0) throw std::runtime_error("TSP file with an EDGE_WEIGHT_SECTION has no DIMENSION.");
+    if (values.size() != shape.offset(n, n)) {
+      throw std::runtime_error("TSP file's edge weight count does not match its DIMENSION.");
+    }
+
+    TSP::DistanceMatrix matrix;
+    matrix.n = n;
+    if (shape.full) {
+      std::vector<uint8_t> asymmetric(n, 0);
+      Parallel::parallelFor(0, n, [&](size_t r) {
+        for (size_t c = 0; c < r && !asymmetric[r]; c++) asymmetric[r] = values[r * n + c] != values[c * n + r];
+      }, threads);
+      if (std::count(asymmetric.begin(), asymmetric.end(), 1)) {
+        matrix.symmetric = false;
+        matrix.weights = std::move(values);
+        return TSP::CitySet(std::move(matrix));
+      }
+    }
+    if (!shape.full && shape.diagonal && !shape.upper) {
+      matrix.weights = std::move(values);
+      return TSP::CitySet(std::move(matrix));
+    }
+
+    // Every (r, c) pair appears in one row only, so rows are placed independently
+    matrix.weights.assign(n * (n + 1) / 2, 0);
+    Parallel::parallelFor(0, n, [&](size_t r) {
+      const size_t start = shape.offset(r, n), low = shape.low(r);
+      const size_t high = shape.full ? r + 1 : shape.high(r, n);
+      for (size_t c = low; c < high; c++) {
+        const size_t i = std::max(r, c), j = std::min(r, c);
+        matrix.weights[i * (i + 1) / 2 + j] = values[start + c - low];
+      }
+    }, threads);
+    return TSP::CitySet(std::move(matrix));
+  }
+
+  // Fills `buffer` with up to `capacity` decompressed bytes; returns 0 at the end of the input
+  using Source = std::function<size_t(char* buffer, size_t capacity)>;
+
+  /**
+   * Parses a .tsp file delivered in blocks. A producer thread fills blocks from `source` while the calling
+   * thread parses the previous ones, so decompression & parsing overlap & at most `STREAM_BLOCKS` blocks (plus
+   * one partial line) are held at once.
+   */
+  TSP::CitySet parseStream(const Source& source) {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::unique_ptr<std::string>> full, empty;
+    bool finished = false, stop = false;
+    std::exception_ptr failure;
+    for (size_t b = 0; b < STREAM_BLOCKS; b++) empty.push_back(std::make_unique<std::string>(STREAM_BLOCK, '\0'));
+
+    std::thread producer([&]() {
+      try {
+        while (true) {
+          std::unique_ptr<std::string> block;
+          {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]() { return stop || !empty.empty(); });
+            if (stop) break;
+            block = std::move(empty.front());
+            empty.pop_front();
+          }
+          block->resize(STREAM_BLOCK);
+          block->resize(source(&(*block)[0], STREAM_BLOCK));
+          if (block->empty()) break;
+          std::lock_guard<std::mutex> guard(lock);
+          full.push_back(std::move(block));
+          changed.notify_all();
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(lock);
+        failure = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      finished = true;
+      changed.notify_all();
+    });
+
+    Header header;
+    TSP::CitySet cities;
+    std::vector<uint32_t> values;
+    Trailer trailer;
+    bool in_section = false, done = false, malformed = false;
+    std::string carry;
+    auto line = [&](const char* p, const char* end) {
+      if (done) { trailer.line(p, end, header); return; }
+      if (!in_section) {
+        in_section = parseHeaderLine(std::string(p, end), header);
+        // DIMENSION <= UINT32_MAX, so the size of its triangle cannot overflow
+        const size_t expected = header.explicit_weights ? header.dimension * (header.dimension + 1) / 2
+                                                        : header.dimension;
+        const size_t reserved = std::min(expected, MAX_RESERVE);
+        if (in_section && header.explicit_weights) values.reserve(reserved);
+        else if (in_section) {
+          cities.ids.reserve(reserved);
+          cities.xs.reserve(reserved);
+          cities.ys.reserve(reserved);
+        }
+        return;
+      }
+      const char* first = skipBlanks(p, end);
+      if (first == end) return;
+      if (std::isalpha(static_cast<unsigned char>(*first))) {
+        done = true;
+        trailer.line(p, end, header);
+        return;
+      }
+      if (header.explicit_weights) {
+        for (const char* q = first; q < end; q = skipBlanks(q, end)) {
+          uint32_t value;
+          q = parseField(q, end, value);
+          if (!q) { malformed = true; return; }
+          values.push_back(value);
+        }
+        return;
+      }
+      size_t id;
+      double x, y;
+      const char* q = parseField(parseField(parseField(p, end, id), end, x), end, y);
+      if (!q) { malformed = true; return; }
+      cities.ids.push_back(id);
+      cities.xs.push_back(x);
+      cities.ys.push_back(y);
+    };
+
+    try {
+      while (!malformed) {
+        std::unique_ptr<std::string> block;
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          changed.wait(guard, [&]() { return finished || !full.empty(); });
+          if (full.empty()) break;
+          block = std::move(full.front());
+          full.pop_front();
+        }
+
+        // Lines that straddle blocks are assembled in `carry`
+        const char* p = block->data();
+        const char* end = p + block->size();
+        while (p < end && !malformed) {
+          const char* stop = lineEnd(p, end);
+          if (stop == end) { carry.append(p, end); break; }
+          if (carry.empty()) line(p, stop);
+          else {
+            carry.append(p, stop);
+            line(carry.data(), carry.data() + carry.size());
+            carry.clear();
+          }
+          p = stop + 1;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        empty.push_back(std::move(block));
+        changed.notify_all();
+      }
+      if (!carry.empty() && !malformed) line(carry.data(), carry.data() + carry.size());
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!failure) failure = std::current_exception();
+    }
+
+    // Release the producer if parsing stopped early, then surface whichever side failed
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stop = true;
+      changed.notify_all();
+    }
+    producer.join();
+    if (failure) std::rethrow_exception(failure);
+    if (!in_section) throw std::runtime_error("TSP file has no NODE_COORD_SECTION or EDGE_WEIGHT_SECTION.");
+    if (malformed && header.explicit_weights) throw std::runtime_error("TSP file has a malformed edge weight.");
+    if (malformed) throw std::runtime_error("TSP file has a malformed coordinate line.");
+    if (header.explicit_weights) cities = explicitCities(header, std::move(values), 1);
+    else validate(cities, header);
+    trailer.finish(cities, header);
+    return cities;
+  }
+
+  bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+
+  [[noreturn]] void unreadable(const std::string& filename) {
+    std::cerr << "ERROR: Could not read file: " << filename << std::endl;
+    throw std::runtime_error("Failed to read file. Terminating.");
+  }
+
+#if TSP_HAVE_ZLIB
+  TSP::CitySet readGzip(const std::string& filename) {
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (!file) unreadable(filename);
+    std::unique_ptr<gzFile_s, int (*)(gzFile)> guard(file, gzclose);
+    gzbuffer(file, 1 << 18);
+    return parseStream([&](char* buffer, size_t capacity) {
+      const int read = gzread(file, buffer, unsigned(capacity));
+      int error = Z_OK;
+      if (read <= 0) gzerror(file, &error);
+      if (read < 0 || (error != Z_OK && error != Z_STREAM_END)) {
+        throw std::runtime_error("Failed to decompress gzip input.");
+      }
+      return size_t(read);
+    });
+  }
+#endif
+
+#if TSP_HAVE_ZSTD
+  TSP::CitySet readZstd(const std::string& filename) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(filename.c_str(), "rb"), std::fclose);
+    if (!file) unreadable(filename);
+    std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> stream(ZSTD_createDStream(), ZSTD_freeDStream);
+    ZSTD_initDStream(stream.get());
+    std::vector<char> compressed(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in{compressed.data(), 0, 0};
+    // The last ZSTD_decompressStream result; non-zero while a frame is unfinished or not yet flushed
+    size_t pending = 0;
+    bool eof = false;
+    return parseStream([&](char* buffer, size_t capacity) {
+      ZSTD_outBuffer out{buffer, capacity, 0};
+      while (out.pos < out.size) {
+        if (in.pos == in.size && !eof) {
+          in.size = std::fread(compressed.data(), 1, compressed.size(), file.get());
+          in.pos = 0;
+          eof = in.size == 0;
+        }
+        if (eof && pending == 0) break;
+        const size_t before = out.pos;
+        pending = ZSTD_decompressStream(stream.get(), &out, &in);
+        if (ZSTD_isError(pending)) throw std::runtime_error("Failed to decompress zstd input.");
+        if (eof && out.pos == before) throw std::runtime_error("Truncated zstd input.");
+      }
+      return out.pos;
+    });
+  }
+#endif
+}
+
+/**
+ * Reads a .tsp file into a city set with `parseCities`. The file is read in a single block, so parsing
+ * rather than the stream is what the threads share.
+ *
+ * Files ending in .gz (with zlib) or .zst (with zstd) are instead decompressed in fixed-size blocks on one
+ * thread while another parses them, so the decompressed text is never held in memory all at once.
+ *
+ * @param filename The path to the TSP file.
+ * @param threads The number of threads parsing coordinates of uncompressed files.
+ * @return The cities of the NODE_COORD_SECTION, in file order, or an `EXPLICIT` set holding the
+ *         EDGE_WEIGHT_SECTION.
+ * @throws std::runtime_error If the file cannot be read, decompressed, or parsed.
+ */
+TSP::CitySet TSP::readCities(const std::string& filename, const size_t& threads) {
+  if (endsWith(filename, ".gz")) {
+#if TSP_HAVE_ZLIB
+    return readGzip(filename);
+#else
+    throw std::runtime_error("Reading .gz files requires zlib, which this build does not have.");
+#endif
+  }
+  if (endsWith(filename, ".zst")) {
+#if TSP_HAVE_ZSTD
+    return readZstd(filename);
+#else
+    throw std::runtime_error("Reading .zst files requires zstd, which this build does not have.");
+#endif
+  }
+
+  std::ifstream fin(filename, std::ios::binary);
+  if (fin.fail()) unreadable(filename);
+  fin.seekg(0, std::ios::end);
+  std::string text(size_t(fin.tellg()), '\0');
+  fin.seekg(0, std::ios::beg);
+  fin.read(&text[0], text.size());
+  return parseCities(text, threads);
+}
+
+/**
+ * Parses the text of a .tsp file into a city set. The NODE_COORD_SECTION is split at line boundaries into
+ * chunks; each thread counts the lines of its chunks, the counts give every chunk its first slot in arrays
+ * preallocated from the DIMENSION header, and each thread then parses its chunks with `std::from_chars`
+ * straight into those slots. Ids are validated once every chunk is done.
+ *
+ * An EDGE_WEIGHT_SECTION of an EXPLICIT instance is split & counted the same way, one value at a time,
+ * then packed into a `DistanceMatrix`: 32-bit weights in one contiguous array, only the lower triangle
+ * for symmetric formats (FULL_MATRIX, UPPER_ROW, LOWER_ROW, UPPER_DIAG_ROW, LOWER_DIAG_ROW & their
+ * column twins).
+ *
+ * CVRP files may follow with a DEMAND_SECTION & DEPOT_SECTION, which are read line by line into the set's
+ * `demands` & `depots` along with the CAPACITY header.
+ *
+ * @param text The whole file.
+ * @param threads The number of threads parsing coordinates or weights.
+ * @return The cities of the NODE_COORD_SECTION, in file order, or an `EXPLICIT` set holding the
+ *         EDGE_WEIGHT_SECTION.
+ * @throws std::runtime_error If there is no NODE_COORD_SECTION or EDGE_WEIGHT_SECTION, a DIMENSION or
+ *                            CAPACITY header is not a count, DIMENSION exceeds UINT32_MAX, a line is not
+ *                            "id x y" or a weight is not an unsigned 32-bit integer, the number of cities or
+ *                            weights differs from DIMENSION, an id repeats, or a demand or depot line is
+ *                            malformed or names an unknown city.
+ */
+TSP::CitySet TSP::parseCities(const std::string& text, const size_t& threads) {
+  Header header;
+  const char* begin = text.data() + parseHeader(text, header);
+  const char* end = text.data() + text.size();
+
+  // Chunk boundaries sit just past a newline
+  const size_t workers = std::max<size_t>(threads, 1);
+  const size_t chunks = std::max<size_t>(1, std::min<size_t>(workers * CHUNKS_PER_THREAD, (end - begin) / 4096 + 1));
+  std::vector<const char*> bounds(chunks + 1, end);
+  bounds[0] = begin;
+  for (size_t c = 1; c < chunks; c++) {
+    const char* p = begin + (end - begin) * c / chunks;
+    bounds[c] = std::max(bounds[c - 1], std::min(end, lineEnd(p, end) + 1));
+  }
+
+  // Chunks count lines of coordinates or single edge weights alike
+  std::vector<size_t> first(chunks + 1, 0);
+  std::vector<const char*> keyword(chunks);
+  Parallel::parallelFor(0, chunks, [&](size_t c) {
+    if (header.explicit_weights) first[c + 1] = countValues(bounds[c], bounds[c + 1], keyword[c]);
+    else first[c + 1] = countLines(bounds[c], bounds[c + 1], keyword[c]);
+  }, threads);
+
+  // The section ends at the first keyword line (EOF or the next section); later chunks are dropped
+  for (size_t c = 0; c < chunks; c++) {
+    if (!keyword[c]) continue;
+    bounds[c + 1] = keyword[c];
+    for (size_t d = c + 1; d < chunks; d++) { bounds[d + 1] = keyword[c]; first[d + 1] = 0; }
+    break;
+  }
+  for (size_t c = 0; c < chunks; c++) first[c + 1] += first[c];
+  const size_t n = first[chunks];
+  std::vector<uint8_t> malformed(chunks, 0);
+
+  if (header.explicit_weights) {
+    std::vector<uint32_t> values(n);
+    Parallel::parallelFor(0, chunks, [&](size_t c) {
+      uint32_t* slot = values.data() + first[c];
+      for (const char* p = skipBlanks(bounds[c], bounds[c + 1]); p < bounds[c + 1] && !malformed[c];) {
+        if (*p == '\n') { p = skipBlanks(p + 1, bounds[c + 1]); continue; }
+        p = parseField(p, bounds[c + 1], *slot++);
+        malformed[c] = !p;
+        if (p) p = skipBlanks(p, bounds[c + 1]);
+      }
+    }, threads);
+    if (std::count(malformed.begin(), malformed.end(), 1)) {
+      throw std::runtime_error("TSP file has a malformed edge weight.");
+    }
+    CitySet cities = explicitCities(header, std::move(values), threads);
+    readTrailer(bounds[chunks], end, cities, header);
+    return cities;
+  }
+
+  if (header.dimension != 0 && n != header.dimension) {
+    throw std::runtime_error("TSP file's coordinate count does not match its DIMENSION.");
+  }
+
+  CitySet cities;
+  cities.ids.resize(n);
+  cities.xs.resize(n);
+  cities.ys.resize(n);
+  Parallel::parallelFor(0, chunks, [&](size_t c) {
+    size_t slot = first[c];
+    for (const char* p = bounds[c]; p < bounds[c + 1] && !malformed[c];) {
+      const char* stop = lineEnd(p, bounds[c + 1]);
+      if (skipBlanks(p, stop) < stop) {
+        const char* q = parseField(p, stop, cities.ids[slot]);
+        q = parseField(q, stop, cities.xs[slot]);
+        malformed[c] = !parseField(q, stop, cities.ys[slot]);
+        slot++;
+      }
+      p = stop + 1;
+    }
+  }, threads);
+  if (std::count(malformed.begin(), malformed.end(), 1)) {
+    throw std::runtime_error("TSP file has a malformed coordinate line.");
+  }
+
+  validate(cities, header);
+  readTrailer(bounds[chunks], end, cities, header);
+  return cities;
+}
+
+/**
+ * Reads a TSPLIB .tour file into an order over a city set, e.g. to warm-start `localSearch`.
+ *
+ * @param filename The path to the tour file.
+ * @param cities The cities the tour's ids refer to.
+ * @return The index of every city once, in tour order.
+ * @throws std::runtime_error If the file cannot be read or is not a tour of `cities`.
+ */
+std::vector<uint32_t> TSP::readTour(const std::string& filename, const CitySet& cities) {
+  std::ifstream fin(filename, std::ios::binary);
+  if (fin.fail()) unreadable(filename);
+  std::string text((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+  return parseTour(text, cities);
+}
+
+/**
+ * Parses the text of a TSPLIB .tour file into an order over a city set. The ids of the TOUR_SECTION, which
+ * ends at -1 or a keyword line, are looked up in `cities.id_index` & checked to visit every city once.
+ *
+ * @param text The whole file.
+ * @param cities The cities the tour's ids refer to.
+ * @return The index of every city once, in tour order.
+ * @throws std::runtime_error If there is no TOUR_SECTION, an id is malformed, unknown or repeated, or a
+ *                            city is missing.
+ */
+std::vector<uint32_t> TSP::parseTour(const std::string& text, const CitySet& cities) {
+  size_t at = 0;
+  bool section = false;
+  while (!section && at < text.size()) {
+    const size_t stop = std::min(text.find('\n', at), text.size());
+    section = trim(text.substr(at, stop - at)).rfind("TOUR_SECTION", 0) == 0;
+    at = std::min(stop + 1, text.size());
+  }
+  if (!section) throw std::runtime_error("Tour file has no TOUR_SECTION.");
+
+  std::vector<uint32_t> order;
+  order.reserve(cities.size());
+  std::vector<bool> seen(cities.size(), false);
+  const char* end = text.data() + text.size();
+  for (const char* p = text.data() + at; p < end;) {
+    if (*p == '\n' || blank(*p)) { p++; continue; }
+    if (std::isalpha(static_cast<unsigned char>(*p))) break;
+    long long id;
+    const std::from_chars_result result = std::from_chars(p, end, id);
+    if (result.ec != std::errc() || (result.ptr < end && !blank(*result.ptr) && *result.ptr != '\n')) {
+      throw std::runtime_error("Tour file has a malformed city id.");
+    }
+    if (id == -1) break;
+    const uint32_t i = id < 0 ? IdIndex::NONE : cities.id_index.find(size_t(id));
+    if (i == IdIndex::NONE) throw std::runtime_error("Tour file visits an unknown city id.");
+    if (seen[i]) throw std::runtime_error("Tour file visits a city twice.");
+    seen[i] = true;
+    order.push_back(i);
+    p = result.ptr;
+  }
+  if (order.size() != cities.size()) throw std::runtime_error("Tour file does not visit every city.");
+  return order;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CitySet.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  /**
+   * Reads a .tsp file into a city set with `parseCities`. The file is read in a single block, so parsing
+   * rather than the stream is what the threads share.
+   *
+   * Files ending in .gz (with zlib) or .zst (with zstd) are instead decompressed in fixed-size blocks on one
+   * thread while another parses them, so the decompressed text is never held in memory all at once.
+   *
+   * @param filename The path to the TSP file.
+   * @param threads The number of threads parsing coordinates of uncompressed files.
+   * @return The cities of the NODE_COORD_SECTION, in file order, or an `EXPLICIT` set holding the
+   *         EDGE_WEIGHT_SECTION.
+   * @throws std::runtime_error If the file cannot be read, decompressed, or parsed.
+   */
+  CitySet readCities(const std::string& filename, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Parses the text of a .tsp file into a city set. The NODE_COORD_SECTION is split at line boundaries into
+   * chunks; each thread counts the lines of its chunks, the counts give every chunk its first slot in arrays
+   * preallocated from the DIMENSION header, and each thread then parses its chunks with `std::from_chars`
+   * straight into those slots. Ids are validated once every chunk is done.
+   *
+   * An EDGE_WEIGHT_SECTION of an EXPLICIT instance is split & counted the same way, one value at a time,
+   * then packed into a `DistanceMatrix`: 32-bit weights in one contiguous array, only the lower triangle
+   * for symmetric formats (FULL_MATRIX, UPPER_ROW, LOWER_ROW, UPPER_DIAG_ROW, LOWER_DIAG_ROW & their
+   * column twins).
+   *
+   * CVRP files may follow with a DEMAND_SECTION & DEPOT_SECTION, which are read line by line into the set's
+   * `demands` & `depots` along with the CAPACITY header.
+   *
+   * @param text The whole file.
+   * @param threads The number of threads parsing coordinates or weights.
+   * @return The cities of the NODE_COORD_SECTION, in file order, or an `EXPLICIT` set holding the
+   *         EDGE_WEIGHT_SECTION.
+   * @throws std::runtime_error If there is no NODE_COORD_SECTION or EDGE_WEIGHT_SECTION, a DIMENSION or
+   *                            CAPACITY header is not a count, DIMENSION exceeds UINT32_MAX, a line is not
+   *                            "id x y" or a weight is not an unsigned 32-bit integer, the number of cities or
+   *                            weights differs from DIMENSION, an id repeats, or a demand or depot line is
+   *                            malformed or names an unknown city.
+   */
+  CitySet parseCities(const std::string& text, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Reads a TSPLIB .tour file into an order over a city set, e.g. to warm-start `localSearch`.
+   *
+   * @param filename The path to the tour file.
+   * @param cities The cities the tour's ids refer to.
+   * @return The index of every city once, in tour order.
+   * @throws std::runtime_error If the file cannot be read or is not a tour of `cities`.
+   */
+  std::vector<uint32_t> readTour(const std::string& filename, const CitySet& cities);
+
+  /**
+   * Parses the text of a TSPLIB .tour file into an order over a city set. The ids of the TOUR_SECTION, which
+   * ends at -1 or a keyword line, are looked up in `cities.id_index` & checked to visit every city once.
+   *
+   * @param text The whole file.
+   * @param cities The cities the tour's ids refer to.
+   * @return The index of every city once, in tour order.
+   * @throws std::runtime_error If there is no TOUR_SECTION, an id is malformed, unknown or repeated, or a
+   *                            city is missing.
+   */
+  std::vector<uint32_t> parseTour(const std::string& text, const CitySet& cities);
+};
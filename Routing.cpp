@@ -0,0 +1,676 @@
+#include "Routing.hpp"
+#include "Candidates.hpp"
+#include "LocalSearch.hpp"
+#include "Multilevel.hpp"
+#include "TSP.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+  constexpr long long INFINITE = std::numeric_limits<long long>::max() / 4;
+
+  constexpr uint32_t NONE = UINT32_MAX;
+
+  // Candidates per city for the giant tour & for every route
+  constexpr size_t GIANT_K = 8;
+  constexpr size_t ROUTE_K = 8;
+
+  // Candidates per customer for CVRP savings & inter-route moves, & rounds of inter- then intra-route search
+  constexpr size_t CVRP_K = 12;
+  constexpr size_t CVRP_ROUNDS = 8;
+
+  // Candidates per city for orienteering insertions, & rounds of insertion, local search & replacement
+  constexpr size_t ORIENTEERING_K = 10;
+  constexpr size_t ORIENTEERING_ROUNDS = 10;
+
+  /**
+   * Copies the given cities of a set into a new set, city q of which is `members[q]`. Matrix sets keep their
+   * weights; coordinate sets are copied as `Node`s.
+   */
+  TSP::CitySet subset(const TSP::CitySet& cities, const std::vector<uint32_t>& members) {
+    const size_t m = members.size();
+    if (cities.mode != TSP::Coordinates::EXPLICIT) {
+      std::vector<Node> nodes;
+      nodes.reserve(m);
+      for (const uint32_t& i : members) nodes.push_back(cities.node(i));
+      return TSP::CitySet(nodes);
+    }
+
+    TSP::DistanceMatrix matrix;
+    matrix.n = m;
+    matrix.symmetric = cities.matrix.symmetric;
+    if (matrix.symmetric) {
+      matrix.weights.reserve(m * (m + 1) / 2);
+      for (size_t a = 0; a < m; a++) {
+        for (size_t b = 0; b <= a; b++) matrix.weights.push_back(cities.matrix(members[a], members[b]));
+      }
+    } else {
+      matrix.weights.reserve(m * m);
+      for (size_t a = 0; a < m; a++) {
+        for (size_t b = 0; b < m; b++) matrix.weights.push_back(cities.matrix(members[a], members[b]));
+      }
+    }
+    return TSP::CitySet(std::move(matrix));
+  }
+
+  void measure(const TSP::CitySet& cities, TSP::Routes& routes) {
+    routes.lengths.clear();
+    routes.total = 0;
+    for (const std::vector<uint32_t>& route : routes.routes) {
+      routes.lengths.push_back(TSP::routeLength(cities, routes.depot, route));
+      routes.total += routes.lengths.back();
+    }
+  }
+
+  /**
+   * Clarke & Wright's parallel savings: every customer starts on its own route, and routes are joined end to
+   * end in decreasing order of the saving d(depot, i) + d(depot, j) - d(i, j) while the joined load fits.
+   * Only pairs (i, j) with j a candidate of i are considered, so the savings list has n * k entries.
+   */
+  TSP::Routes savings(const TSP::CitySet& cities, const TSP::Candidates& near, const std::vector<size_t>& demands,
+                      const size_t& capacity, const size_t& depot, const size_t& threads) {
+    struct Saving {
+      long long value;
+      uint32_t i, j;
+    };
+    const size_t n = cities.size();
+    std::vector<Saving> list(n * near.k, Saving{0, NONE, NONE});
+    Parallel::parallelFor(0, n, [&](size_t i) {
+      if (i == depot) return;
+      for (size_t q = 0; q < near.k; q++) {
+        const uint32_t j = near.of(i)[q];
+        if (j == depot) continue;
+        const long long value = (long long)cities.distance(depot, i) + (long long)cities.distance(depot, j) -
+                                (long long)cities.distance(i, j);
+        list[i * near.k + q] = {value, uint32_t(i), j};
+      }
+    }, threads);
+    list.erase(std::remove_if(list.begin(), list.end(), [](const Saving& s) { return s.i == NONE || s.value <= 0; }),
+               list.end());
+    std::sort(list.begin(), list.end(), [](const Saving& l, const Saving& r) {
+      return l.value != r.value ? l.value > r.value : (l.i != r.i ? l.i < r.i : l.j < r.j);
+    });
+
+    // Routes are doubly linked lists (NONE stands for the depot) whose loads sit at union-find roots
+    std::vector<uint32_t> root(n), link(2 * n, NONE);
+    std::vector<size_t> load(demands);
+    for (uint32_t c = 0; c < n; c++) root[c] = c;
+    auto find = [&](uint32_t c) {
+      while (root[c] != c) c = root[c] = root[root[c]];
+      return c;
+    };
+    auto end = [&](const uint32_t& c) { return link[2 * c] == NONE || link[2 * c + 1] == NONE; };
+    auto attach = [&](const uint32_t& c, const uint32_t& to) { link[2 * c + (link[2 * c] == NONE ? 0 : 1)] = to; };
+    for (const Saving& s : list) {
+      const uint32_t a = find(s.i), b = find(s.j);
+      if (a == b || !end(s.i) || !end(s.j) || load[a] + load[b] > capacity) continue;
+      attach(s.i, s.j);
+      attach(s.j, s.i);
+      root[b] = a;
+      load[a] += load[b];
+    }
+
+    TSP::Routes routes;
+    routes.depot = depot;
+    std::vector<bool> seen(n, false);
+    for (uint32_t c = 0; c < n; c++) {
+      if (c == depot || seen[c] || !end(c)) continue;
+      routes.routes.emplace_back();
+      for (uint32_t previous = NONE, at = c; at != NONE;) {
+        seen[at] = true;
+        routes.routes.back().push_back(at);
+        const uint32_t next = link[2 * at] != previous ? link[2 * at] : link[2 * at + 1];
+        previous = at;
+        at = next;
+      }
+    }
+    measure(cities, routes);
+    return routes;
+  }
+
+  /**
+   * Inter-route local search for the CVRP: relocate a customer into another route, swap two customers of
+   * different routes, and 2-opt* (exchange the tails, or join the heads & the tails, of two routes), each
+   * tried against the candidates of a customer taken from a queue of "dirty" customers. Per-route prefix
+   * loads make every capacity check O(1); a move rewrites only the two routes it touches.
+   */
+  class RouteSearch {
+  public:
+    RouteSearch(const TSP::CitySet& cities_, const TSP::Candidates& candidates_, const std::vector<size_t>& demands_,
+                const size_t& capacity_, TSP::Routes& routes_)
+      : cities{cities_}, candidates{candidates_}, demands{demands_}, capacity{capacity_}, routes{routes_},
+        depot{uint32_t(routes_.depot)}, route_of(cities_.size(), NONE), pos_of(cities_.size(), 0),
+        prefix(routes_.routes.size()), queued(cities_.size(), false) {
+      for (size_t r = 0; r < routes.routes.size(); r++) {
+        rebuild(r);
+        for (const uint32_t& c : routes.routes[r]) touch(c);
+      }
+    }
+
+    void run() {
+      while (!queue.empty()) {
+        const uint32_t u = queue.front();
+        queue.pop_front();
+        queued[u] = false;
+        improve(u);
+      }
+      routes.routes.erase(std::remove_if(routes.routes.begin(), routes.routes.end(),
+                                         [](const std::vector<uint32_t>& route) { return route.empty(); }),
+                          routes.routes.end());
+      measure(cities, routes);
+    }
+
+  private:
+    enum class Kind { RELOCATE_AFTER, RELOCATE_BEFORE, SWAP, TAILS, HEADS };
+
+    const TSP::CitySet& cities;
+    const TSP::Candidates& candidates;
+    const std::vector<size_t>& demands;
+    const size_t capacity;
+    TSP::Routes& routes;
+    const uint32_t depot;
+    std::vector<uint32_t> route_of, pos_of;
+    std::vector<std::vector<size_t>> prefix;
+    std::deque<uint32_t> queue;
+    std::vector<bool> queued;
+
+    void touch(const uint32_t& c) {
+      if (c != depot && !queued[c]) { queued[c] = true; queue.push_back(c); }
+    }
+
+    long long dist(const uint32_t& i, const uint32_t& j) const { return cities.distance(i, j); }
+
+    uint32_t pred(const uint32_t& c) const {
+      return pos_of[c] == 0 ? depot : routes.routes[route_of[c]][pos_of[c] - 1];
+    }
+    uint32_t succ(const uint32_t& c) const {
+      const std::vector<uint32_t>& route = routes.routes[route_of[c]];
+      return pos_of[c] + 1 == route.size() ? depot : route[pos_of[c] + 1];
+    }
+
+    // prefix[r][p] is the load of the first p customers of route r
+    size_t load(const size_t& r) const { return prefix[r].back(); }
+
+    void rebuild(const size_t& r) {
+      const std::vector<uint32_t>& route = routes.routes[r];
+      prefix[r].assign(route.size() + 1, 0);
+      for (size_t p = 0; p < route.size(); p++) {
+        route_of[route[p]] = r;
+        pos_of[route[p]] = p;
+        prefix[r][p + 1] = prefix[r][p] + demands[route[p]];
+      }
+    }
+
+    void improve(const uint32_t& u) {
+      const uint32_t a = route_of[u], i = pos_of[u], pu = pred(u), nu = succ(u);
+      const long long removal = dist(pu, u) + dist(u, nu) - dist(pu, nu);
+      long long best = 0;
+      Kind kind = Kind::SWAP;
+      uint32_t best_v = NONE;
+      for (size_t q = 0; q < candidates.k; q++) {
+        const uint32_t v = candidates.of(u)[q];
+        if (v == depot || route_of[v] == a) continue;
+        const uint32_t b = route_of[v], j = pos_of[v], pv = pred(v), nv = succ(v);
+        auto consider = [&](const long long& gain, const Kind& k) {
+          if (gain > best) { best = gain; kind = k; best_v = v; }
+        };
+
+        if (load(b) + demands[u] <= capacity) {
+          consider(removal + dist(v, nv) - dist(v, u) - dist(u, nv), Kind::RELOCATE_AFTER);
+          consider(removal + dist(pv, v) - dist(pv, u) - dist(u, v), Kind::RELOCATE_BEFORE);
+        }
+        if (load(a) - demands[u] + demands[v] <= capacity && load(b) - demands[v] + demands[u] <= capacity) {
+          consider(dist(pu, u) + dist(u, nu) + dist(pv, v) + dist(v, nv) -
+                   dist(pu, v) - dist(v, nu) - dist(pv, u) - dist(u, nv), Kind::SWAP);
+        }
+        // Tails: a[..i] + b[j..] & b[..j) + a(i..]; heads: a[..i] + reversed b[..j] & reversed a(i..] + b(j..]
+        const size_t head_a = prefix[a][i + 1], head_b = prefix[b][j], through_b = prefix[b][j + 1];
+        if (head_a + load(b) - head_b <= capacity && head_b + load(a) - head_a <= capacity) {
+          consider(dist(u, nu) + dist(pv, v) - dist(u, v) - dist(pv, nu), Kind::TAILS);
+        }
+        if (head_a + through_b <= capacity && load(a) - head_a + load(b) - through_b <= capacity) {
+          consider(dist(u, nu) + dist(v, nv) - dist(u, v) - dist(nu, nv), Kind::HEADS);
+        }
+      }
+      if (best <= 0) return;
+
+      const uint32_t v = best_v, b = route_of[v], j = pos_of[v], pv = pred(v), nv = succ(v);
+      std::vector<uint32_t>& ra = routes.routes[a];
+      std::vector<uint32_t>& rb = routes.routes[b];
+      if (kind == Kind::RELOCATE_AFTER || kind == Kind::RELOCATE_BEFORE) {
+        ra.erase(ra.begin() + i);
+        rb.insert(rb.begin() + j + (kind == Kind::RELOCATE_AFTER ? 1 : 0), u);
+      } else if (kind == Kind::SWAP) {
+        std::swap(ra[i], rb[j]);
+      } else {
+        std::vector<uint32_t> first(ra.begin(), ra.begin() + i + 1), second;
+        if (kind == Kind::TAILS) {
+          first.insert(first.end(), rb.begin() + j, rb.end());
+          second.assign(rb.begin(), rb.begin() + j);
+          second.insert(second.end(), ra.begin() + i + 1, ra.end());
+        } else {
+          first.insert(first.end(), rb.rend() - j - 1, rb.rend());
+          second.assign(ra.rbegin(), ra.rend() - i - 1);
+          second.insert(second.end(), rb.begin() + j + 1, rb.end());
+        }
+        ra.swap(first);
+        rb.swap(second);
+      }
+      rebuild(a);
+      rebuild(b);
+      for (const uint32_t& c : {u, v, pu, nu, pv, nv}) touch(c);
+    }
+  };
+
+  /**
+   * Orienteering by insertion & replacement. The tour is a doubly linked list over city indices, so inserting
+   * or removing a city is O(1), and a city is only ever inserted next to a tour city among its candidates or
+   * the cities that list it as a candidate, so evaluating an insertion costs O(k). Coordinate sets use
+   * quadrant candidates, whose graph is connected, so the tour can grow out of any cluster.
+   */
+  class Orienteer {
+  public:
+    Orienteer(const TSP::CitySet& cities_, const std::vector<double>& scores_, const size_t& budget_,
+              const size_t& start_, const size_t& threads_)
+      : cities{cities_}, scores{scores_}, budget{(long long)std::min<size_t>(budget_, size_t(INFINITE))},
+        start{uint32_t(start_)}, threads{threads_}, n{cities_.size()},
+        near{TSP::buildCandidates(cities_, ORIENTEERING_K, cities_.mode == TSP::Coordinates::EXPLICIT
+                                  ? TSP::CandidateRule::NEAREST : TSP::CandidateRule::QUADRANT, threads_)},
+        first(n + 1, 0),
+        next(n, NONE), prev(n, NONE) {
+      // Reverse candidate lists, so a city also sees the cities that list it
+      for (size_t c = 0; c < n; c++) for (size_t q = 0; q < near.k; q++) first[near.of(c)[q] + 1]++;
+      for (size_t c = 0; c < n; c++) first[c + 1] += first[c];
+      listed_by.resize(first[n]);
+      std::vector<size_t> slot(first.begin(), first.end() - 1);
+      for (uint32_t c = 0; c < n; c++) for (size_t q = 0; q < near.k; q++) listed_by[slot[near.of(c)[q]]++] = c;
+
+      next[start] = prev[start] = start;
+      score = scores[start];
+    }
+
+    TSP::ScoredTour run() {
+      for (size_t round = 0; round < ORIENTEERING_ROUNDS; round++) {
+        const double before = score;
+        fill();
+        const long long shortened = shorten();
+        replace();
+        if (score <= before && shortened == 0) break;
+      }
+
+      TSP::ScoredTour result;
+      result.order.push_back(start);
+      for (uint32_t c = next[start]; c != start; c = next[c]) result.order.push_back(c);
+      result.length = length;
+      result.score = score;
+      return result;
+    }
+
+  private:
+    // A pending insertion of `city` after `after`, ranked by score per unit of added length
+    struct Insertion {
+      double ratio;
+      uint32_t city, after;
+      long long cost;
+      bool operator<(const Insertion& other) const { return ratio < other.ratio; }
+    };
+
+    const TSP::CitySet& cities;
+    const std::vector<double>& scores;
+    const long long budget;
+    const uint32_t start;
+    const size_t threads;
+    const size_t n;
+    const TSP::Candidates near;
+    std::vector<size_t> first;
+    std::vector<uint32_t> listed_by, next, prev;
+    long long length = 0;
+    double score = 0;
+
+    long long dist(const uint32_t& i, const uint32_t& j) const { return cities.distance(i, j); }
+    bool visited(const uint32_t& c) const { return next[c] != NONE; }
+
+    template <typename F>
+    void neighbors(const uint32_t& c, const F& f) const {
+      for (size_t q = 0; q < near.k; q++) f(near.of(c)[q]);
+      for (size_t q = first[c]; q < first[c + 1]; q++) f(listed_by[q]);
+    }
+
+    // The cheapest insertion of c next to a neighboring tour city, or cost INFINITE if there is none
+    Insertion evaluate(const uint32_t& c) const {
+      Insertion best{0, c, NONE, INFINITE};
+      auto consider = [&](const uint32_t& x) {
+        const long long cost = dist(x, c) + dist(c, next[x]) - (x == next[x] ? 0 : dist(x, next[x]));
+        if (cost < best.cost) { best.cost = cost; best.after = x; }
+      };
+      neighbors(c, [&](const uint32_t& v) {
+        if (!visited(v)) return;
+        consider(v);
+        consider(prev[v]);
+      });
+      if (best.cost < INFINITE) best.ratio = scores[c] / double(std::max(best.cost, 0LL) + 1);
+      return best;
+    }
+
+    void insert(const Insertion& insertion) {
+      const uint32_t c = insertion.city, x = insertion.after, y = next[x];
+      next[x] = c; prev[c] = x;
+      next[c] = y; prev[y] = c;
+      length += insertion.cost;
+      score += scores[c];
+    }
+
+    void remove(const uint32_t& c) {
+      const uint32_t x = prev[c], y = next[c];
+      length -= dist(x, c) + dist(c, y) - (x == y ? 0 : dist(x, y));
+      next[x] = y; prev[y] = x;
+      next[c] = prev[c] = NONE;
+      score -= scores[c];
+    }
+
+    /**
+     * Greedy insertion by score per added length. Entries go stale as the tour changes, so each is
+     * re-evaluated when it reaches the top & requeued if its cost moved.
+     */
+    void fill() {
+      std::priority_queue<Insertion> heap;
+      auto offer = [&](const uint32_t& c) {
+        if (visited(c)) return;
+        const Insertion insertion = evaluate(c);
+        if (insertion.cost < INFINITE && length + insertion.cost <= budget) heap.push(insertion);
+      };
+      for (uint32_t c = 0; c < n; c++) offer(c);
+      while (!heap.empty()) {
+        const Insertion top = heap.top();
+        heap.pop();
+        if (visited(top.city)) continue;
+        const Insertion current = evaluate(top.city);
+        if (current.cost != top.cost || current.after != top.after) {
+          if (current.cost < INFINITE && length + current.cost <= budget) heap.push(current);
+          continue;
+        }
+        if (length + current.cost > budget) continue;
+        insert(current);
+        neighbors(current.city, offer);
+      }
+    }
+
+    // Runs `localSearch` over the visited cities; returns how much shorter the tour got
+    long long shorten() {
+      std::vector<uint32_t> members(1, start);
+      for (uint32_t c = next[start]; c != start; c = next[c]) members.push_back(c);
+      if (members.size() < 5) return 0;
+
+      const TSP::CitySet local = subset(cities, members);
+      std::vector<uint32_t> order(members.size());
+      for (size_t q = 0; q < order.size(); q++) order[q] = q;
+      order = TSP::localSearch(local, TSP::nearestCandidates(local, ROUTE_K, threads), order);
+
+      const long long before = length;
+      length = 0;
+      for (size_t q = 0; q < order.size(); q++) {
+        const uint32_t c = members[order[q]], d = members[order[(q + 1) % order.size()]];
+        next[c] = d;
+        prev[d] = c;
+        length += dist(c, d);
+      }
+      return before - length;
+    }
+
+    /**
+     * For every unvisited city, best first, that no longer fits: drops the lowest-scoring neighboring tour
+     * city whose removal frees enough length for it, when that city scores less.
+     */
+    void replace() {
+      std::vector<uint32_t> waiting;
+      for (uint32_t c = 0; c < n; c++) if (!visited(c)) waiting.push_back(c);
+      std::sort(waiting.begin(), waiting.end(), [&](const uint32_t& a, const uint32_t& b) {
+        return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+      });
+      for (const uint32_t& c : waiting) {
+        if (visited(c)) continue;
+        const Insertion insertion = evaluate(c);
+        if (insertion.cost >= INFINITE) continue;
+        if (length + insertion.cost <= budget) { insert(insertion); continue; }
+
+        uint32_t drop = NONE;
+        neighbors(c, [&](const uint32_t& w) {
+          if (!visited(w) || w == start || w == insertion.after || w == next[insertion.after]) return;
+          if (scores[w] >= scores[c] || (drop != NONE && scores[w] >= scores[drop])) return;
+          const long long saving = dist(prev[w], w) + dist(w, next[w]) - dist(prev[w], next[w]);
+          if (length - saving + insertion.cost <= budget) drop = w;
+        });
+        if (drop == NONE) continue;
+        remove(drop);
+        insert(insertion);
+      }
+    }
+  };
+}
+
+/**
+ * @param cities The city set the indices refer to.
+ * @param depot The index of the depot.
+ * @param route The cities of one route, in order, without the depot.
+ * @return The length of the closed route depot -> route... -> depot.
+ */
+size_t TSP::routeLength(const CitySet& cities, const size_t& depot, const std::vector<uint32_t>& route) {
+  if (route.empty()) return 0;
+  size_t length = cities.distance(depot, route.front()) + cities.distance(route.back(), depot);
+  for (size_t p = 1; p < route.size(); p++) length += cities.distance(route[p - 1], route[p]);
+  return length;
+}
+
+/**
+ * Splits a giant tour into routes of consecutive cities with Prins' split, choosing the cut points that
+ * minimize the total length of exactly `vehicles` routes (or one per city, if there are fewer cities)
+ * among those whose routes are at most `max_length` long.
+ *
+ * @param cities The city set the indices refer to.
+ * @param tour Every index of `cities` once, in tour order; the depot may be anywhere in it.
+ * @param depot The index of the depot.
+ * @param vehicles The number of routes.
+ * @param max_length The longest a route may be, depot edges included.
+ * @return The routes, in tour order.
+ * @throws std::runtime_error If no split of the tour keeps every route within `max_length`.
+ */
+TSP::Routes TSP::splitTour(const CitySet& cities, const std::vector<uint32_t>& tour, const size_t& depot,
+                           const size_t& vehicles, const size_t& max_length) {
+  // The cities to serve, t[1..n], in tour order after the depot
+  std::vector<uint32_t> t(1, uint32_t(depot));
+  const size_t at = std::find(tour.begin(), tour.end(), depot) - tour.begin();
+  for (size_t p = 1; p < tour.size(); p++) t.push_back(tour[(at + p) % tour.size()]);
+  const size_t n = t.size() - 1;
+
+  Routes result;
+  result.depot = depot;
+  const size_t m = std::min(vehicles, n);
+  if (m == 0) return result;
+
+  // Route t[i+1..j] is out[i] + back[j] long, where out[i] = d(depot, t[i+1]) - path[i+1]
+  std::vector<long long> path(n + 1, 0), out(n), back(n + 1);
+  for (size_t j = 2; j <= n; j++) path[j] = path[j - 1] + cities.distance(t[j - 1], t[j]);
+  for (size_t i = 0; i < n; i++) out[i] = (long long)cities.distance(depot, t[i + 1]) - path[i + 1];
+  for (size_t j = 1; j <= n; j++) back[j] = path[j] + (long long)cities.distance(t[j], depot);
+  const long long limit = max_length >= size_t(INFINITE) ? INFINITE : (long long)max_length;
+
+  // Route t[i+1..j] fits the limit when out[i] <= limit - back[j]. Rounded or explicit distances need not obey
+  // the triangle inequality, so a cut too long for one j may fit a later one: rather than a sliding window,
+  // each layer keeps a prefix-minimum Fenwick tree over the cuts seen so far, ordered by out[i]
+  std::vector<uint32_t> rank(n), by_out(n);
+  std::vector<long long> sorted_out(n);
+  for (uint32_t i = 0; i < n; i++) by_out[i] = i;
+  std::stable_sort(by_out.begin(), by_out.end(),
+                   [&](const uint32_t& a, const uint32_t& b) { return out[a] < out[b]; });
+  for (size_t r = 0; r < n; r++) {
+    rank[by_out[r]] = uint32_t(r);
+    sorted_out[r] = out[by_out[r]];
+  }
+
+  // cost[j] is the least length of the routes covering t[1..j] in the current layer; cut[k][j] its last cut
+  std::vector<long long> previous(n + 1, INFINITE), cost(n + 1, INFINITE);
+  std::vector<std::vector<uint32_t>> cut(m + 1, std::vector<uint32_t>(n + 1, 0));
+  std::vector<uint32_t> tree(n + 1);
+  // The cheaper cut into the layer, ties going to the later cut
+  auto better = [&](const uint32_t& a, const uint32_t& b) {
+    if (a == NONE || b == NONE) return b == NONE && a != NONE;
+    const long long va = previous[a] + out[a], vb = previous[b] + out[b];
+    return va < vb || (va == vb && a > b);
+  };
+  previous[0] = 0;
+  for (size_t k = 1; k <= m; k++) {
+    std::fill(cost.begin(), cost.end(), INFINITE);
+    std::fill(tree.begin(), tree.end(), NONE);
+    for (size_t j = k; j <= n - (m - k); j++) {
+      // Cut j - 1 joins the tree
+      const uint32_t i = uint32_t(j - 1);
+      if (previous[i] < INFINITE) {
+        for (size_t p = rank[i] + 1; p <= n; p += p & -p) if (better(i, tree[p])) tree[p] = i;
+      }
+      // The cheapest of the cuts whose route to j fits the limit
+      const size_t fits =
+          std::upper_bound(sorted_out.begin(), sorted_out.end(), limit - back[j]) - sorted_out.begin();
+      uint32_t best = NONE;
+      for (size_t p = fits; p > 0; p -= p & -p) if (better(tree[p], best)) best = tree[p];
+      if (best == NONE) continue;
+      cost[j] = previous[best] + out[best] + back[j];
+      cut[k][j] = best;
+    }
+    previous.swap(cost);
+  }
+  if (previous[n] >= INFINITE) {
+    throw std::runtime_error("The tour cannot be split into routes within the length limit.");
+  }
+
+  result.routes.resize(m);
+  for (size_t k = m, j = n; k > 0; k--) {
+    const size_t i = cut[k][j];
+    result.routes[k - 1].assign(t.begin() + i + 1, t.begin() + j + 1);
+    j = i;
+  }
+  for (const std::vector<uint32_t>& route : result.routes) {
+    result.lengths.push_back(routeLength(cities, depot, route));
+    result.total += result.lengths.back();
+  }
+  return result;
+}
+
+/**
+ * Improves every route on its own with `localSearch` (`directedSearch` for asymmetric sets) over the route's
+ * cities & the depot, routes in parallel. No route gets longer.
+ *
+ * @param cities The city set the indices refer to.
+ * @param routes The routes to improve, in place.
+ * @param threads The number of threads optimizing routes.
+ */
+void TSP::optimizeRoutes(const CitySet& cities, Routes& routes, const size_t& threads) {
+  Parallel::parallelFor(0, routes.routes.size(), [&](size_t r) {
+    std::vector<uint32_t>& route = routes.routes[r];
+    std::vector<uint32_t> members(1, uint32_t(routes.depot));
+    members.insert(members.end(), route.begin(), route.end());
+    if (members.size() < 5) return;
+
+    const CitySet local = subset(cities, members);
+    std::vector<uint32_t> order(members.size());
+    for (size_t q = 0; q < order.size(); q++) order[q] = q;
+    order = localSearch(local, nearestCandidates(local, std::min(ROUTE_K, members.size() - 1), 1), order);
+    for (size_t q = 1; q < order.size(); q++) route[q - 1] = members[order[q]];
+    routes.lengths[r] = routeLength(cities, routes.depot, route);
+  }, threads);
+
+  routes.total = 0;
+  for (const size_t& length : routes.lengths) routes.total += length;
+}
+
+/**
+ * Solves the multiple TSP from a depot: builds a giant tour (`multilevel` for coordinate sets,
+ * `nearestNeighbor` & `localSearch` for matrices), cuts it into routes with `splitTour`, and refines the
+ * routes with `optimizeRoutes`.
+ *
+ * @param cities The depot & the cities to visit.
+ * @param depot The index of the depot.
+ * @param vehicles The number of routes.
+ * @param max_length The longest a route may be, depot edges included.
+ * @param threads The number of threads building the giant tour & optimizing routes.
+ * @return The routes.
+ * @throws std::runtime_error If no split of the giant tour keeps every route within `max_length`.
+ */
+TSP::Routes TSP::mtsp(const CitySet& cities, const size_t& depot, const size_t& vehicles,
+                      const size_t& max_length, const size_t& threads) {
+  std::vector<uint32_t> tour;
+  if (cities.mode == Coordinates::EXPLICIT) {
+    tour = nearestNeighbor(cities, depot);
+    tour = localSearch(cities, nearestCandidates(cities, GIANT_K, threads), std::move(tour));
+  } else {
+    tour = multilevel(cities, 1000, threads);
+  }
+
+  Routes routes = splitTour(cities, tour, depot, vehicles, max_length);
+  optimizeRoutes(cities, routes, threads);
+  return routes;
+}
+
+/**
+ * Solves the capacitated VRP from a depot: Clarke & Wright savings over candidate pairs build the routes,
+ * then rounds of inter-route search (relocate, swap, 2-opt*, with O(1) capacity checks from prefix loads)
+ * alternate with `optimizeRoutes` until a round no longer shortens the routes.
+ *
+ * @param cities The depot & the customers; distances must be symmetric.
+ * @param demands The demand of every city by index; the depot's is ignored.
+ * @param capacity The load every route may carry.
+ * @param depot The index of the depot.
+ * @param threads The number of threads building candidate lists & savings & optimizing routes.
+ * @return The routes, each within `capacity`.
+ * @throws std::runtime_error If `cities` is asymmetric, `demands` does not cover every city, or a single
+ *                            customer's demand exceeds `capacity`.
+ */
+TSP::Routes TSP::cvrp(const CitySet& cities, const std::vector<size_t>& demands, const size_t& capacity,
+                      const size_t& depot, const size_t& threads) {
+  const size_t n = cities.size();
+  if (!cities.symmetric()) throw std::runtime_error("CVRP routes need symmetric distances.");
+  if (demands.size() != n) throw std::runtime_error("CVRP demands must cover every city.");
+  std::vector<size_t> load(demands);
+  load[depot] = 0;
+  if (std::any_of(load.begin(), load.end(), [&](const size_t& q) { return q > capacity; })) {
+    throw std::runtime_error("A customer's demand exceeds the vehicle capacity.");
+  }
+
+  const Candidates near = nearestCandidates(cities, CVRP_K, threads);
+  Routes routes = savings(cities, near, load, capacity, depot, threads);
+  for (size_t round = 0; round < CVRP_ROUNDS; round++) {
+    const size_t before = routes.total;
+    RouteSearch(cities, near, load, capacity, routes).run();
+    optimizeRoutes(cities, routes, threads);
+    if (routes.total >= before) break;
+  }
+  return routes;
+}
+
+/**
+ * Solves the orienteering problem: a closed tour from `start`, at most `budget` long, that collects as much
+ * score as it can. Cities are inserted greedily by score per unit of added length; `localSearch` then
+ * shortens the tour, freeing budget for further insertions, and a replacement pass trades a tour city for a
+ * higher-scoring neighbor that did not fit, for a few rounds until nothing changes.
+ *
+ * @param cities The cities that may be visited.
+ * @param scores The score of every city by index.
+ * @param budget The longest the tour may be.
+ * @param start The index of the city the tour starts & ends at; it is always visited.
+ * @param threads The number of threads building candidate lists.
+ * @return The tour, starting with `start`, with its length & collected score.
+ * @throws std::runtime_error If `scores` does not cover every city.
+ */
+TSP::ScoredTour TSP::orienteering(const CitySet& cities, const std::vector<double>& scores, const size_t& budget,
+                                  const size_t& start, const size_t& threads) {
+  if (scores.size() != cities.size()) throw std::runtime_error("Orienteering scores must cover every city.");
+  if (cities.size() < 2) {
+    ScoredTour tour;
+    if (cities.size() == 1) { tour.order.push_back(start); tour.score = scores[start]; }
+    return tour;
+  }
+  return Orienteer(cities, scores, budget, start, threads).run();
+}
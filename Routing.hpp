@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "CitySet.hpp"
+#include "Parallel.hpp"
+
+namespace TSP {
+  /**
+   * Vehicle routes from a shared depot: each route lists the indices of the cities one vehicle visits, in
+   * order, without the depot it leaves from & returns to.
+   *
+   * @details
+   * - `lengths[r]` is the length of route r including both depot edges.
+   * - `total` is the sum of `lengths`.
+   */
+  struct Routes {
+    size_t depot;
+    std::vector<std::vector<uint32_t>> routes;
+    std::vector<size_t> lengths;
+    size_t total;
+
+    Routes() : depot{0}, routes{}, lengths{}, total{0} {};
+  };
+
+  /**
+   * A closed tour over some of the cities, with the total score of the cities it visits.
+   */
+  struct ScoredTour {
+    std::vector<uint32_t> order;
+    size_t length;
+    double score;
+
+    ScoredTour() : order{}, length{0}, score{0} {};
+  };
+
+  /**
+   * @param cities The city set the indices refer to.
+   * @param depot The index of the depot.
+   * @param route The cities of one route, in order, without the depot.
+   * @return The length of the closed route depot -> route... -> depot.
+   */
+  size_t routeLength(const CitySet& cities, const size_t& depot, const std::vector<uint32_t>& route);
+
+  /**
+   * Splits a giant tour into routes of consecutive cities with Prins' split, choosing the cut points that
+   * minimize the total length of exactly `vehicles` routes (or one per city, if there are fewer cities)
+   * among those whose routes are at most `max_length` long.
+   *
+   * @details
+   * Each fleet size is one layer of a shortest path over the tour's cut points. A route's length is an
+   * offset that depends on its first city plus one that depends on its last, so a route fits the limit when
+   * its first offset is small enough for its last city. Every layer finds the cheapest such cut with a
+   * prefix-minimum Fenwick tree over the cuts ordered by that offset, which stays exact when rounded or
+   * explicit distances break the triangle inequality: O(vehicles * n log n) in all.
+   *
+   * @param cities The city set the indices refer to.
+   * @param tour Every index of `cities` once, in tour order; the depot may be anywhere in it.
+   * @param depot The index of the depot.
+   * @param vehicles The number of routes.
+   * @param max_length The longest a route may be, depot edges included.
+   * @return The routes, in tour order.
+   * @throws std::runtime_error If no split of the tour keeps every route within `max_length`.
+   */
+  Routes splitTour(const CitySet& cities, const std::vector<uint32_t>& tour, const size_t& depot,
+                   const size_t& vehicles, const size_t& max_length = SIZE_MAX);
+
+  /**
+   * Improves every route on its own with `localSearch` (`directedSearch` for asymmetric sets) over the route's
+   * cities & the depot, routes in parallel. No route gets longer.
+   *
+   * @param cities The city set the indices refer to.
+   * @param routes The routes to improve, in place.
+   * @param threads The number of threads optimizing routes.
+   */
+  void optimizeRoutes(const CitySet& cities, Routes& routes, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Solves the multiple TSP from a depot: builds a giant tour (`multilevel` for coordinate sets,
+   * `nearestNeighbor` & `localSearch` for matrices), cuts it into routes with `splitTour`, and refines the
+   * routes with `optimizeRoutes`.
+   *
+   * @param cities The depot & the cities to visit.
+   * @param depot The index of the depot.
+   * @param vehicles The number of routes.
+   * @param max_length The longest a route may be, depot edges included.
+   * @param threads The number of threads building the giant tour & optimizing routes.
+   * @return The routes.
+   * @throws std::runtime_error If no split of the giant tour keeps every route within `max_length`.
+   */
+  Routes mtsp(const CitySet& cities, const size_t& depot, const size_t& vehicles,
+              const size_t& max_length = SIZE_MAX, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Solves the capacitated VRP from a depot: Clarke & Wright savings over candidate pairs build the routes,
+   * then rounds of inter-route search (relocate, swap, 2-opt*, with O(1) capacity checks from prefix loads)
+   * alternate with `optimizeRoutes` until a round no longer shortens the routes.
+   *
+   * @details
+   * Savings & inter-route moves only pair a customer with its `nearestCandidates`, so both scale with n * k
+   * rather than n^2. A TSPLIB CVRP file read by `readCities` supplies `cities.demands`, `cities.capacity` &
+   * `cities.depots`.
+   *
+   * @param cities The depot & the customers; distances must be symmetric.
+   * @param demands The demand of every city by index; the depot's is ignored.
+   * @param capacity The load every route may carry.
+   * @param depot The index of the depot.
+   * @param threads The number of threads building candidate lists & savings & optimizing routes.
+   * @return The routes, each within `capacity`.
+   * @throws std::runtime_error If `cities` is asymmetric, `demands` does not cover every city, or a single
+   *                            customer's demand exceeds `capacity`.
+   */
+  Routes cvrp(const CitySet& cities, const std::vector<size_t>& demands, const size_t& capacity,
+              const size_t& depot = 0, const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Solves the orienteering problem: a closed tour from `start`, at most `budget` long, that collects as much
+   * score as it can. Cities are inserted greedily by score per unit of added length; `localSearch` then
+   * shortens the tour, freeing budget for further insertions, and a replacement pass trades a tour city for a
+   * higher-scoring neighbor that did not fit, for a few rounds until nothing changes.
+   *
+   * @details
+   * The tour is a linked list, and a city is only inserted next to a tour city among its candidates (quadrant
+   * candidates for coordinate sets, nearest for matrices) or those listing it, so each insertion or removal
+   * is evaluated in O(k) & the tour only grows into the neighborhood of cities it already visits.
+   *
+   * @param cities The cities that may be visited.
+   * @param scores The score of every city by index.
+   * @param budget The longest the tour may be.
+   * @param start The index of the city the tour starts & ends at; it is always visited.
+   * @param threads The number of threads building candidate lists.
+   * @return The tour, starting with `start`, with its length & collected score.
+   * @throws std::runtime_error If `scores` does not cover every city.
+   */
+  ScoredTour orienteering(const CitySet& cities, const std::vector<double>& scores, const size_t& budget,
+                          const size_t& start = 0, const size_t& threads = Parallel::defaultThreads());
+};
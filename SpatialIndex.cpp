@@ -0,0 +1,162 @@
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+/**
+ * Buckets every city of the set into the grid.
+ *
+ * @param cities The cities to index.
+ * @param per_cell The average number of cities per cell.
+ */
+TSP::SpatialGrid::SpatialGrid(const CitySet& cities_, const double& per_cell)
+  : cities{cities_}, min_x{0}, min_y{0}, cell{1}, cols{1}, rows{1} {
+  const size_t n = cities.size();
+  if (n > 0) {
+    double max_x = cities.x(0), max_y = cities.y(0);
+    min_x = max_x;
+    min_y = max_y;
+    for (size_t i = 1; i < n; i++) {
+      min_x = std::min(min_x, cities.x(i));
+      max_x = std::max(max_x, cities.x(i));
+      min_y = std::min(min_y, cities.y(i));
+      max_y = std::max(max_y, cities.y(i));
+    }
+    const double width = std::max(max_x - min_x, 1e-9), height = std::max(max_y - min_y, 1e-9);
+    cell = std::max(std::sqrt(width * height * per_cell / n), 1e-9);
+    cols = std::min<size_t>(size_t(width / cell) + 1, n + 1);
+    rows = std::min<size_t>(size_t(height / cell) + 1, n + 1);
+    cell = std::max(cell, std::max(width / cols, height / rows) * (1 + 1e-12));
+  }
+
+  // Counting sort of cities by cell
+  cell_start.assign(cols * rows + 1, 0);
+  std::vector<uint32_t> home(n);
+  for (size_t i = 0; i < n; i++) {
+    home[i] = row(cities.y(i)) * cols + column(cities.x(i));
+    cell_start[home[i] + 1]++;
+  }
+  for (size_t c = 0; c < cols * rows; c++) cell_start[c + 1] += cell_start[c];
+  items.resize(n);
+  std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+  for (size_t i = 0; i < n; i++) items[fill[home[i]]++] = i;
+}
+
+/**
+ * The squared distance between city i at (x, y) & city j. Fixed-point sets use their exact integer squared
+ * distance (converted & scaled with correctly rounded operations), so neighbor order is reproducible.
+ * Float sets return the single-precision approximation, which `nearest` re-ranks exactly near the cutoff.
+ */
+double TSP::SpatialGrid::squared(const size_t& i, const size_t& j, const double& x, const double& y) const {
+  if (cities.mode == Coordinates::FIXED_POINT) {
+    return double(cities.fixedSquaredDistance(i, j)) / (double(cities.scale) * double(cities.scale));
+  }
+  if (cities.mode == Coordinates::FLOAT) {
+    const float dx = cities.float_xs[j] - cities.float_xs[i], dy = cities.float_ys[j] - cities.float_ys[i];
+    return dx * dx + dy * dy;
+  }
+  const double dx = cities.x(j) - x, dy = cities.y(j) - y;
+  return dx * dx + dy * dy;
+}
+
+size_t TSP::SpatialGrid::column(const double& x) const {
+  return std::min<size_t>(size_t((x - min_x) / cell), cols - 1);
+}
+
+size_t TSP::SpatialGrid::row(const double& y) const {
+  return std::min<size_t>(size_t((y - min_y) / cell), rows - 1);
+}
+
+/**
+ * Finds the k cities nearest to city i, excluding i itself, ordered by increasing distance
+ * (ties broken by lower index), optionally only within one quadrant around city i.
+ *
+ * Searches square rings of cells around the query's cell; once k cities are held, the search stops at
+ * the first ring whose inner edge is farther away than the k-th best city. For float sets, every city whose
+ * float distance could still place it in the true k nearest is re-ranked with double coordinates, so the
+ * result is the same as for a double set.
+ *
+ * @param i The index of the query city.
+ * @param k The number of neighbors wanted; fewer are returned if the set is smaller.
+ * @param out Receives the indices of the neighbors.
+ * @param quadrant -1 for any direction, or q in 0..3 for cities with (dx < 0) + 2 * (dy < 0) == q.
+ */
+void TSP::SpatialGrid::nearest(const size_t& i, const size_t& k, std::vector<uint32_t>& out,
+                               const int& quadrant) const {
+  out.clear();
+  if (k == 0) return;
+  const double x = cities.x(i), y = cities.y(i);
+  const long cx = column(x), cy = row(y);
+
+  // Cells entirely on the wrong side of the query's row or column cannot hold quadrant members
+  auto cellInQuadrant = [&](const long& gx, const long& gy) {
+    if (quadrant < 0) return true;
+    return ((quadrant & 1) ? gx <= cx : gx >= cx) && ((quadrant & 2) ? gy <= cy : gy >= cy);
+  };
+  auto inQuadrant = [&](const uint32_t& j) {
+    return quadrant < 0 || int(cities.x(j) < x) + 2 * int(cities.y(j) < y) == quadrant;
+  };
+
+  // Max-heap of the best k (squared distance, index) pairs, plus every city seen when distances are approximate
+  std::priority_queue<std::pair<double, uint32_t>> best;
+  const bool approximate = cities.mode == Coordinates::FLOAT;
+  std::vector<std::pair<double, uint32_t>> seen;
+
+  // Any city of the true k nearest has an approximate distance within twice the error bound of the k-th
+  auto cutoff = [&]() {
+    const double kth = std::sqrt(best.top().first);
+    return approximate ? kth + 2 * cities.floatErrorBound(kth) : kth;
+  };
+
+  const long reach = long(std::max(cols, rows));
+  for (long r = 0; r <= reach; r++) {
+    if (best.size() == k) {
+      const double inner = (r - 1) * cell;
+      if (inner > 0 && inner > cutoff()) break;
+    }
+    // Rings only grow outward, so once a ring has no cell inside the grid (and quadrant) none will
+    bool inside = false;
+    for (long gy = cy - r; gy <= cy + r; gy++) {
+      if (gy < 0 || gy >= long(rows)) continue;
+      const bool edge_row = gy == cy - r || gy == cy + r;
+      for (long gx = cx - r; gx <= cx + r; gx += (edge_row ? 1 : 2 * r)) {
+        if (gx >= 0 && gx < long(cols) && cellInQuadrant(gx, gy)) {
+          inside = true;
+          const size_t c = gy * cols + gx;
+          for (size_t t = cell_start[c]; t < cell_start[c + 1]; t++) {
+            const uint32_t j = items[t];
+            if (j == i || !inQuadrant(j)) continue;
+            std::pair<double, uint32_t> entry{squared(i, j, x, y), j};
+            if (approximate) seen.push_back(entry);
+            if (best.size() < k) best.push(entry);
+            else if (entry < best.top()) { best.pop(); best.push(entry); }
+          }
+        }
+        if (r == 0) break;
+      }
+    }
+    if (!inside) break;
+  }
+
+  if (approximate && !best.empty()) {
+    const double limit = cutoff();
+    std::vector<std::pair<double, uint32_t>> exact;
+    for (const std::pair<double, uint32_t>& entry : seen) {
+      if (std::sqrt(entry.first) > limit) continue;
+      const double dx = cities.xs[entry.second] - x, dy = cities.ys[entry.second] - y;
+      exact.push_back({dx * dx + dy * dy, entry.second});
+    }
+    std::sort(exact.begin(), exact.end());
+    exact.resize(std::min(exact.size(), k));
+    out.resize(exact.size());
+    for (size_t t = 0; t < exact.size(); t++) out[t] = exact[t].second;
+    return;
+  }
+
+  out.resize(best.size());
+  for (size_t t = best.size(); t-- > 0;) {
+    out[t] = best.top().second;
+    best.pop();
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "CitySet.hpp"
+
+namespace TSP {
+  /**
+   * A uniform grid over the bounding box of a city set, sized for a few cities per cell.
+   * Cities are bucketed by cell with a counting sort, so each cell's members are contiguous.
+   *
+   * @note The grid keeps a reference to the city set, which must outlive it.
+   */
+  class SpatialGrid {
+  public:
+    /**
+     * Buckets every city of the set into the grid.
+     *
+     * @param cities The cities to index.
+     * @param per_cell The average number of cities per cell.
+     */
+    explicit SpatialGrid(const CitySet& cities, const double& per_cell = 2.0);
+
+    /**
+     * Finds the k cities nearest to city i, excluding i itself, ordered by increasing distance
+     * (ties broken by lower index), optionally only within one quadrant around city i.
+     *
+     * @param i The index of the query city.
+     * @param k The number of neighbors wanted; fewer are returned if the set (or quadrant) is smaller.
+     * @param out Receives the indices of the neighbors.
+     * @param quadrant -1 for any direction, or q in 0..3 for cities with (dx < 0) + 2 * (dy < 0) == q.
+     */
+    void nearest(const size_t& i, const size_t& k, std::vector<uint32_t>& out, const int& quadrant = -1) const;
+
+  private:
+    const CitySet& cities;
+    double min_x, min_y, cell;
+    size_t cols, rows;
+    std::vector<uint32_t> cell_start;
+    std::vector<uint32_t> items;
+
+    size_t column(const double& x) const;
+    size_t row(const double& y) const;
+    double squared(const size_t& i, const size_t& j, const double& x, const double& y) const;
+  };
+};
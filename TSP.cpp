@@ -1,4 +1,5 @@
 #include "TSP.hpp"
+#include "Kernels.hpp"
 
 /**
  * Displays the edges and total distance of the tour.
@@ -172,11 +173,10 @@ TSP::Tour TSP::nearestNeighbor(std::list<Node> cities, const size_t &start_id)
 
     for (auto it = std::next(cities.begin()); it != cities.end(); ++it)
     {
-      // Check mins
-      size_t dist = current.distance(*it);
-      if (dist < min_distance)
+      // Check mins; the rounded distance is only computed for a new minimum
+      if (current.closerThan(*it, min_distance))
       {
-        min_distance = dist;
+        min_distance = current.distance(*it);
         nearest_it = it;
       }
     }
@@ -198,4 +198,94 @@ TSP::Tour TSP::nearestNeighbor(std::list<Node> cities, const size_t &start_id)
   tour.total_distance += return_distance;
 
   return tour;
+}
+
+/**
+ * Runs the nearest neighbor heuristic over a city set through `Kernels::nearest`, so it also applies to
+ * `EXPLICIT` sets that have no `Node` coordinates. Ties go to the lowest index.
+ *
+ * @param cities The cities to be visited.
+ * @param start The index of the starting city.
+ * @return Every index of `cities` once, in tour order, starting with `start`.
+ */
+std::vector<uint32_t> TSP::nearestNeighbor(const CitySet& cities, const size_t& start) {
+  const size_t n = cities.size();
+  if (n == 0) return {};
+
+  // Unvisited cities are kept packed at the back of `order`, so each step scans only those
+  std::vector<uint32_t> order(n);
+  for (uint32_t i = 0; i < n; i++) order[i] = i;
+  std::swap(order[0], order[start]);
+  for (size_t p = 1; p < n; p++) {
+    const uint32_t current = order[p - 1];
+    std::swap(order[p], order[p + Kernels::nearest(cities, current, order.data() + p, n - p)]);
+  }
+  return order;
+}
+
+/**
+ * Runs `nearestNeighbor` from each of several starting cities & keeps the shortest tour. Starts are folded
+ * with `Parallel::parallelReduce` one per block, so the result does not depend on the number of threads.
+ *
+ * @param cities The cities to be visited.
+ * @param starts The indices of the starting cities to try.
+ * @param threads The number of threads building tours.
+ * @return The shortest of the tours; ties go to the start listed first. Empty if `starts` is.
+ */
+std::vector<uint32_t> TSP::nearestNeighbor(const CitySet& cities, const std::vector<uint32_t>& starts,
+                                           const size_t& threads) {
+  using Scored = std::pair<size_t, std::vector<uint32_t>>;
+  Scored best = Parallel::parallelReduce(0, starts.size(), Scored{SIZE_MAX, {}}, [&](size_t s) {
+    Scored tour{0, nearestNeighbor(cities, starts[s])};
+    const std::vector<uint32_t>& order = tour.second;
+    for (size_t i = 0; i < order.size(); i++) tour.first += cities.distance(order[i], order[(i + 1) % order.size()]);
+    return tour;
+  }, [](const Scored& a, const Scored& b) { return b.first < a.first ? b : a; }, threads, 1);
+  return best.second;
+}
+
+/**
+ * Builds a closed tour that visits the given cities in order and returns to the first one.
+ *
+ * @param order The cities in visiting order, without the closing return to the first city.
+ * @return A `TSP::Tour` whose path, weights, & total distance follow the same conventions as `nearestNeighbor`.
+ */
+TSP::Tour TSP::makeTour(const std::vector<Node>& order) {
+  TSP::Tour tour;
+  if (order.empty()) return tour;
+
+  tour.path.reserve(order.size() + 1);
+  tour.weights.reserve(order.size() + 1);
+  tour.path.push_back(order.front());
+  tour.weights.push_back(0);
+  for (size_t i = 1; i < order.size(); i++) {
+    size_t dist = order[i-1].distance(order[i]);
+    tour.path.push_back(order[i]);
+    tour.weights.push_back(dist);
+    tour.total_distance += dist;
+  }
+
+  // Return to starting city
+  size_t return_distance = order.back().distance(order.front());
+  tour.path.push_back(order.front());
+  tour.weights.push_back(return_distance);
+  tour.total_distance += return_distance;
+  return tour;
+}
+
+/**
+ * Computes the dense, row-major matrix of rounded distances between every pair of the given cities.
+ *
+ * @param cities The cities to measure; row & column i refer to `cities[i]`.
+ * @return An n * n vector where entry (i * n + j) is `cities[i].distance(cities[j])`.
+ */
+std::vector<uint32_t> TSP::distanceMatrix(const std::vector<Node>& cities) {
+  const size_t n = cities.size();
+  std::vector<uint32_t> dist(n * n, 0);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = i + 1; j < n; j++) {
+      dist[i * n + j] = dist[j * n + i] = cities[i].distance(cities[j]);
+    }
+  }
+  return dist;
 }
\ No newline at end of file
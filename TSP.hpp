@@ -5,8 +5,11 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
 
 #include "Node.hpp"
+#include "CitySet.hpp"
+#include "Parallel.hpp"
 
 namespace TSP {
   /**
@@ -59,4 +62,42 @@ namespace TSP {
  *
  */
   Tour nearestNeighbor(std::list<Node> cities, const size_t& start_id = 1);
+
+  /**
+   * Runs the nearest neighbor heuristic over a city set through `Kernels::nearest`, so it also applies to
+   * `EXPLICIT` sets that have no `Node` coordinates. Ties go to the lowest index.
+   *
+   * @param cities The cities to be visited.
+   * @param start The index of the starting city.
+   * @return Every index of `cities` once, in tour order, starting with `start`.
+   */
+  std::vector<uint32_t> nearestNeighbor(const CitySet& cities, const size_t& start = 0);
+
+  /**
+   * Runs `nearestNeighbor` from each of several starting cities, starts in parallel, & keeps the shortest tour.
+   *
+   * @param cities The cities to be visited.
+   * @param starts The indices of the starting cities to try.
+   * @param threads The number of threads building tours.
+   * @return The shortest of the tours, starting with its own start; ties go to the start listed first. Empty if
+   *         `starts` is.
+   */
+  std::vector<uint32_t> nearestNeighbor(const CitySet& cities, const std::vector<uint32_t>& starts,
+                                        const size_t& threads = Parallel::defaultThreads());
+
+  /**
+   * Builds a closed tour that visits the given cities in order and returns to the first one.
+   *
+   * @param order The cities in visiting order, without the closing return to the first city.
+   * @return A `TSP::Tour` whose path, weights, & total distance follow the same conventions as `nearestNeighbor`.
+   */
+  Tour makeTour(const std::vector<Node>& order);
+
+  /**
+   * Computes the dense, row-major matrix of rounded distances between every pair of the given cities.
+   *
+   * @param cities The cities to measure; row & column i refer to `cities[i]`.
+   * @return An n * n vector where entry (i * n + j) is `cities[i].distance(cities[j])`.
+   */
+  std::vector<uint32_t> distanceMatrix(const std::vector<Node>& cities);
 };
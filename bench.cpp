@@ -0,0 +1,499 @@
+#include "Candidates.hpp"
+#include "CitySet.hpp"
+#include "Kernels.hpp"
+#include "LocalSearch.hpp"
+#include "Multilevel.hpp"
+#include "Reader.hpp"
+#include "Routing.hpp"
+#include "TSP.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  double secondsSince(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  /**
+   * Generates a deterministic clustered instance: tight gaussian clusters scattered over a large square,
+   * the kind of layout where plain K-nearest lists never leave their own cluster.
+   */
+  std::list<Node> clusteredCities(const size_t& n, const size_t& clusters, const uint64_t& seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> centre(0.0, 1000000.0);
+    std::normal_distribution<double> spread(0.0, 2000.0);
+    std::vector<std::pair<double, double>> centres(clusters);
+    for (auto& c : centres) c = {centre(rng), centre(rng)};
+
+    std::list<Node> cities;
+    for (size_t i = 0; i < n; i++) {
+      const auto& c = centres[i % clusters];
+      cities.emplace_back(i + 1, c.first + spread(rng), c.second + spread(rng));
+    }
+    return cities;
+  }
+
+  /**
+   * Writes a deterministic .tsp file of n cities spread uniformly over a large square, with 4 decimals.
+   */
+  std::string generatedFile(const size_t& n, const uint64_t& seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coordinate(0.0, 1000000.0);
+    std::string text = "NAME : generated\nTYPE : TSP\nDIMENSION : " + std::to_string(n) +
+                       "\nEDGE_WEIGHT_TYPE : EUC_2D\nNODE_COORD_SECTION\n";
+    char line[96];
+    for (size_t i = 1; i <= n; i++) {
+      std::snprintf(line, sizeof(line), "%zu %.4f %.4f\n", i, coordinate(rng), coordinate(rng));
+      text += line;
+    }
+    text += "EOF\n";
+    return text;
+  }
+
+  size_t tourLength(const TSP::CitySet& cities, const std::vector<uint32_t>& order) {
+    size_t total = 0;
+    for (size_t i = 0; i < order.size(); i++) total += cities.distance(order[i], order[(i + 1) % order.size()]);
+    return total;
+  }
+
+  /**
+   * Compares candidate rules (nearest, quadrant & popmusic, plus alpha-nearness with 5 per city, with &
+   * without penalties) by the time to build the lists, the time local search takes from a nearest-neighbor
+   * start, and the length of the resulting tour.
+   */
+  void benchCandidates(const std::string& name, const std::list<Node>& nodes, const size_t& k) {
+    TSP::CitySet cities(nodes);
+    TSP::Tour start = TSP::nearestNeighbor(nodes, nodes.front().id);
+    std::vector<uint32_t> order;
+    order.reserve(cities.size());
+    for (size_t i = 0; i + 1 < start.path.size(); i++) order.push_back(cities.index(start.path[i].id));
+
+    const std::pair<const char*, std::function<TSP::Candidates()>> rules[] = {
+      {"nearest", [&] { return TSP::buildCandidates(cities, k, TSP::CandidateRule::NEAREST); }},
+      {"quadrant", [&] { return TSP::buildCandidates(cities, k, TSP::CandidateRule::QUADRANT); }},
+      {"popmusic", [&] { return TSP::buildCandidates(cities, k, TSP::CandidateRule::POPMUSIC); }},
+      {"alpha", [&] { return TSP::alphaCandidates(cities, 5); }},
+      {"alpha+pi", [&] { return TSP::alphaCandidates(cities, 5, 10); }},
+    };
+    std::printf("%s (n = %zu, k = %zu, nearest neighbor %zu)\n", name.c_str(), cities.size(), k,
+                tourLength(cities, order));
+    for (const auto& rule : rules) {
+      Clock::time_point built = Clock::now();
+      TSP::Candidates candidates = rule.second();
+      const double build_time = secondsSince(built);
+
+      Clock::time_point searched = Clock::now();
+      std::vector<uint32_t> result = TSP::localSearch(cities, candidates, order);
+      const double search_time = secondsSince(searched);
+      std::printf("  %-10s build %8.3f s   search %8.3f s   length %zu\n", rule.first, build_time, search_time,
+                  tourLength(cities, result));
+    }
+  }
+
+  /**
+   * Compares the multilevel constructor against a flat nearest-neighbor tour refined by the same local search.
+   */
+  void benchMultilevel(const std::string& name, const std::list<Node>& nodes) {
+    TSP::CitySet cities(nodes);
+    std::printf("%s (n = %zu)\n", name.c_str(), cities.size());
+
+    Clock::time_point flat = Clock::now();
+    TSP::Tour start = TSP::nearestNeighbor(nodes, nodes.front().id);
+    std::vector<uint32_t> order;
+    order.reserve(cities.size());
+    for (size_t i = 0; i + 1 < start.path.size(); i++) order.push_back(cities.index(start.path[i].id));
+    order = TSP::localSearch(cities, TSP::nearestCandidates(cities, 8), order);
+    std::printf("  %-10s total %8.3f s   length %zu\n", "flat", secondsSince(flat), tourLength(cities, order));
+
+    Clock::time_point multi = Clock::now();
+    order = TSP::multilevel(cities);
+    std::printf("  %-10s total %8.3f s   length %zu\n", "multilevel", secondsSince(multi), tourLength(cities, order));
+  }
+
+  /**
+   * Times the mTSP pipeline (giant tour, split, per-route local search), unlimited & then with routes capped at
+   * 3/4 of the longest unlimited route, the CVRP solver on random demands of 1 to 10, and orienteering on
+   * random scores of 1 to 100.
+   */
+  void benchRouting(const std::string& name, const std::list<Node>& nodes, const size_t& vehicles) {
+    TSP::CitySet cities(nodes);
+    std::printf("%s routing (n = %zu, %zu vehicles)\n", name.c_str(), cities.size(), vehicles);
+    size_t limit = SIZE_MAX;
+    for (int pass = 0; pass < 2; pass++) {
+      Clock::time_point routed = Clock::now();
+      TSP::Routes routes = TSP::mtsp(cities, 0, vehicles, limit);
+      const size_t longest = *std::max_element(routes.lengths.begin(), routes.lengths.end());
+      std::printf("  limit %-12s total %8.3f s   length %zu   longest route %zu\n",
+                  pass == 0 ? "none" : std::to_string(limit).c_str(), secondsSince(routed), routes.total, longest);
+      limit = longest * 3 / 4;
+    }
+
+    std::mt19937_64 rng(5);
+    std::vector<size_t> demands(cities.size());
+    for (size_t& demand : demands) demand = 1 + rng() % 10;
+    Clock::time_point solved = Clock::now();
+    TSP::Routes routes = TSP::cvrp(cities, demands, 200, 0);
+    std::printf("  %-18s total %8.3f s   length %zu   routes %zu\n", "cvrp, capacity 200", secondsSince(solved),
+                routes.total, routes.routes.size());
+
+    std::vector<double> scores(cities.size());
+    for (double& score : scores) score = double(1 + rng() % 100);
+    const size_t budget = routes.total / 20;
+    Clock::time_point collected = Clock::now();
+    TSP::ScoredTour tour = TSP::orienteering(cities, scores, budget, 0);
+    std::printf("  %-18s total %8.3f s   length %zu   score %.0f of %zu cities\n", "orienteering",
+                secondsSince(collected), tour.length, tour.score, tour.order.size());
+  }
+
+  /**
+   * Measures the overhead of the shared thread pool: the round trip of a loop whose blocks do nothing, next to
+   * spawning & joining a thread per block as `parallelFor` once did; the cost per index of a trivial loop at
+   * several grain sizes; a reduction against the same sum on one thread; & `nearestNeighbor` from 4 starts.
+   */
+  void benchPool(const std::list<Node>& nodes) {
+    const size_t threads = std::max<size_t>(4, Parallel::defaultThreads());
+    std::printf("thread pool, %zu threads\n", threads);
+    const size_t loops = 2000;
+    Clock::time_point started = Clock::now();
+    for (size_t l = 0; l < loops; l++) Parallel::parallelFor(0, threads, [](size_t) {}, threads, 1);
+    std::printf("  %-24s %8.2f us per loop\n", "empty loop, pool", 1e6 * secondsSince(started) / loops);
+    started = Clock::now();
+    for (size_t l = 0; l < loops; l++) {
+      std::vector<std::thread> spawned;
+      for (size_t t = 1; t < threads; t++) spawned.emplace_back([]() {});
+      for (std::thread& t : spawned) t.join();
+    }
+    std::printf("  %-24s %8.2f us per loop\n", "empty loop, spawn & join", 1e6 * secondsSince(started) / loops);
+
+    const size_t n = size_t(1) << 22;
+    std::vector<uint64_t> values(n);
+    for (const size_t& grain : {size_t(1), size_t(16), size_t(256), size_t(0)}) {
+      started = Clock::now();
+      Parallel::parallelFor(0, n, [&](size_t i) { values[i] = i * i; }, threads, grain);
+      const std::string label = "grain " + (grain ? std::to_string(grain) : std::string("auto"));
+      std::printf("  %-24s %8.2f ns per index\n", label.c_str(), 1e9 * secondsSince(started) / n);
+    }
+
+    started = Clock::now();
+    uint64_t sequential = 0;
+    for (size_t i = 0; i < n; i++) sequential += values[i] >> 8;
+    const double one = secondsSince(started);
+    started = Clock::now();
+    const uint64_t reduced = Parallel::parallelReduce(0, n, uint64_t(0), [&](size_t i) { return values[i] >> 8; },
+                                                      [](const uint64_t& a, const uint64_t& b) { return a + b; },
+                                                      threads);
+    std::printf("  %-24s %8.3f ms   (1 thread %.3f ms, %s)\n", "parallelReduce", 1e3 * secondsSince(started),
+                1e3 * one, reduced == sequential ? "same sum" : "SUMS DIFFER");
+
+    if (nodes.empty()) return;
+    const TSP::CitySet cities(nodes);
+    std::vector<uint32_t> starts(4);
+    for (size_t s = 0; s < starts.size(); s++) starts[s] = uint32_t(s * cities.size() / starts.size());
+    for (const size_t& t : {size_t(1), threads}) {
+      started = Clock::now();
+      const std::vector<uint32_t> order = TSP::nearestNeighbor(cities, starts, t);
+      const std::string label = "nearestNeighbor x4, " + std::to_string(t) + " thr";
+      std::printf("  %-24s %8.3f s   length %zu\n", label.c_str(), secondsSince(started), tourLength(cities, order));
+    }
+  }
+
+  /**
+   * The training workload of `make pgo`: parses the given file & generated ones with every parser, then builds
+   * tours on the file, a uniform & a clustered instance with multi-start nearest neighbor, local search over
+   * nearest & quadrant candidates, and the multilevel scheme, so the profile covers the loops those spend
+   * their time in.
+   */
+  void train(const std::string& filename) {
+    std::vector<TSP::CitySet> sets;
+    if (!TSP::constructCities(filename).empty()) sets.push_back(TSP::readCities(filename));
+    const std::string text = generatedFile(200000, 5);
+    for (const size_t& threads : {size_t(1), Parallel::defaultThreads()}) TSP::parseCities(text, threads);
+    sets.push_back(TSP::parseCities(generatedFile(10000, 7)));
+    sets.emplace_back(clusteredCities(10000, 20, 9));
+
+    for (const TSP::CitySet& cities : sets) {
+      Clock::time_point started = Clock::now();
+      const std::vector<uint32_t> starts = {0, uint32_t(cities.size() / 2)};
+      const std::vector<uint32_t> order = TSP::nearestNeighbor(cities, starts);
+      for (const TSP::CandidateRule& rule : {TSP::CandidateRule::NEAREST, TSP::CandidateRule::QUADRANT}) {
+        TSP::localSearch(cities, TSP::buildCandidates(cities, 8, rule), order);
+      }
+      TSP::multilevel(cities);
+      std::printf("trained on %zu cities in %.3f s\n", cities.size(), secondsSince(started));
+    }
+  }
+
+  /**
+   * Times the loops `make pgo` trains, on one thread so builds compare on the same work: nearest neighbor,
+   * local search from its tour, the multilevel scheme, and parsing a generated file. Each is the best of 3
+   * runs; `make pgo` runs this in the builds with & without the profile.
+   */
+  void benchThroughput(const std::string& filename) {
+    std::list<Node> nodes = TSP::constructCities(filename);
+    if (nodes.empty()) nodes = clusteredCities(10000, 20, 9);
+    const TSP::CitySet cities(nodes);
+    const size_t n = cities.size();
+    const TSP::Candidates candidates = TSP::nearestCandidates(cities, 8, 1);
+    const std::string text = generatedFile(200000, 5);
+    std::vector<uint32_t> order;
+    const std::pair<const char*, std::function<void()>> loops[] = {
+      {"nearestNeighbor", [&] { order = TSP::nearestNeighbor(cities, 0); }},
+      {"localSearch", [&] { TSP::localSearch(cities, candidates, order); }},
+      {"multilevel", [&] { TSP::multilevel(cities, 1000, 1); }},
+      {"parseCities", [&] { TSP::parseCities(text, 1); }},
+    };
+    std::printf("throughput (n = %zu, 1 thread, %s kernels, best of 3)\n", n,
+                Kernels::levelName(Kernels::activeLevel()));
+    for (const auto& loop : loops) {
+      double best = 1e300;
+      for (int run = 0; run < 3; run++) {
+        Clock::time_point started = Clock::now();
+        loop.second();
+        best = std::min(best, secondsSince(started));
+      }
+      const bool parse = std::string(loop.first) == "parseCities";
+      std::printf("  %-24s %8.3f s   %10.0f %s/s\n", loop.first, best, (parse ? text.size() / 1e6 : n) / best,
+                  parse ? "MB" : "cities");
+    }
+  }
+
+  /**
+   * Times nearest neighbor & local search at every kernel level the CPU supports, checking that each level
+   * builds the same tours, then restores the level that was active.
+   */
+  void benchKernels(const std::list<Node>& nodes) {
+    const Kernels::Level active = Kernels::activeLevel();
+    const TSP::CitySet cities(nodes);
+    const TSP::Candidates candidates = TSP::nearestCandidates(cities, 8, 1);
+    std::printf("kernels (n = %zu, detected %s, active %s)\n", cities.size(),
+                Kernels::levelName(Kernels::supportedLevel()), Kernels::levelName(active));
+    size_t lengths[2] = {0, 0};
+    for (int level = 0; level <= int(Kernels::supportedLevel()); level++) {
+      Kernels::setLevel(Kernels::Level(level));
+      Clock::time_point built = Clock::now();
+      const std::vector<uint32_t> initial = TSP::nearestNeighbor(cities, 0);
+      const double nn = secondsSince(built);
+      Clock::time_point searched = Clock::now();
+      const std::vector<uint32_t> order = TSP::localSearch(cities, candidates, initial);
+      const double ls = secondsSince(searched);
+      const size_t found[2] = {tourLength(cities, initial), tourLength(cities, order)};
+      const bool same = level == 0 || (found[0] == lengths[0] && found[1] == lengths[1]);
+      if (level == 0) std::copy(found, found + 2, lengths);
+      std::printf("  %-8s nearestNeighbor %8.3f s   localSearch %8.3f s   %s\n",
+                  Kernels::levelName(Kernels::Level(level)), nn, ls, same ? "same tours" : "TOURS DIFFER");
+    }
+    Kernels::setLevel(active);
+  }
+
+  /**
+   * The nearest neighbor loop `nearestNeighbor` ran before `Node::closerThan`: the rounded distance of every
+   * unvisited city, compared with `<` so ties keep the first city found.
+   */
+  TSP::Tour legacyNearestNeighbor(std::list<Node> cities, const size_t& start_id) {
+    auto start_it = std::find_if(cities.begin(), cities.end(), [&](const Node& c) { return c.id == start_id; });
+    Node current = *start_it;
+    cities.erase(start_it);
+
+    TSP::Tour tour;
+    tour.path.push_back(current);
+    tour.weights.push_back(0);
+    tour.total_distance = 0;
+    while (!cities.empty()) {
+      auto nearest_it = cities.begin();
+      size_t min_distance = current.distance(*nearest_it);
+      for (auto it = std::next(cities.begin()); it != cities.end(); ++it) {
+        size_t dist = current.distance(*it);
+        if (dist < min_distance) {
+          min_distance = dist;
+          nearest_it = it;
+        }
+      }
+      tour.path.push_back(*nearest_it);
+      tour.weights.push_back(min_distance);
+      tour.total_distance += min_distance;
+      current = *nearest_it;
+      cities.erase(nearest_it);
+    }
+
+    size_t return_distance = current.distance(tour.path.front());
+    tour.path.push_back(tour.path.front());
+    tour.weights.push_back(return_distance);
+    tour.total_distance += return_distance;
+    return tour;
+  }
+
+  /**
+   * Checks that `nearestNeighbor` builds the same tour as `legacyNearestNeighbor` from every city of the file:
+   * the same path, the same weights & the same total. Starts run in parallel on all threads.
+   *
+   * @return The number of starts whose tours differ.
+   */
+  size_t verifyNearestNeighbor(const std::string& filename) {
+    const std::list<Node> nodes = TSP::constructCities(filename);
+    const std::vector<Node> starts(nodes.begin(), nodes.end());
+    std::vector<char> differs(starts.size(), 0);
+    Clock::time_point started = Clock::now();
+    Parallel::parallelFor(0, starts.size(), [&](size_t s) {
+      const TSP::Tour expected = legacyNearestNeighbor(nodes, starts[s].id);
+      const TSP::Tour found = TSP::nearestNeighbor(nodes, starts[s].id);
+      bool same = expected.total_distance == found.total_distance && expected.weights == found.weights &&
+                  expected.path.size() == found.path.size();
+      for (size_t i = 0; same && i < found.path.size(); i++) same = expected.path[i].id == found.path[i].id;
+      differs[s] = !same;
+    }, Parallel::defaultThreads(), 1);
+
+    size_t failures = 0;
+    for (size_t s = 0; s < starts.size(); s++) {
+      if (!differs[s]) continue;
+      if (failures++ < 10) std::printf("  start %zu: tours differ\n", starts[s].id);
+    }
+    std::printf("nearestNeighbor on %s: %zu of %zu starts match the sqrt & round loop (%.1f s)\n",
+                filename.c_str(), starts.size() - failures, starts.size(), secondsSince(started));
+    return failures;
+  }
+
+  /**
+   * Checks `splitTour` against every way of cutting a tour into its routes, on random instances of 3 to 10
+   * cities: half spread over a large square, half packed into a 6 x 6 box where rounded distances break the
+   * triangle inequality, each split with no limit & with a random one. Both must agree on whether a split
+   * fits the limit and on the least total length.
+   *
+   * @return The number of instances where they differ.
+   */
+  size_t verifySplit(const size_t& instances) {
+    std::mt19937_64 rng(17);
+    size_t failures = 0, limited = 0;
+    for (size_t s = 0; s < instances; s++) {
+      const size_t n = 3 + rng() % 8;
+      const double side = s % 2 ? 6.0 : 1000.0;
+      std::uniform_real_distribution<double> coordinate(0.0, side);
+      std::list<Node> nodes;
+      for (size_t c = 0; c < n; c++) nodes.emplace_back(c + 1, coordinate(rng), coordinate(rng));
+      const TSP::CitySet cities(nodes);
+      std::vector<uint32_t> tour(n);
+      for (uint32_t c = 0; c < n; c++) tour[c] = c;
+      std::shuffle(tour.begin(), tour.end(), rng);
+      const size_t depot = rng() % n, vehicles = 1 + rng() % (n - 1);
+
+      // The cities after the depot; each mask of the n - 2 inner gaps with m - 1 bits is one split
+      std::vector<uint32_t> t;
+      const size_t at = std::find(tour.begin(), tour.end(), depot) - tour.begin();
+      for (size_t p = 1; p < n; p++) t.push_back(tour[(at + p) % n]);
+      const size_t m = std::min(vehicles, t.size());
+      std::vector<std::pair<size_t, size_t>> splits;  // total & longest route
+      for (size_t mask = 0; mask < (size_t(1) << (t.size() - 1)); mask++) {
+        if (size_t(__builtin_popcountll(mask)) != m - 1) continue;
+        std::pair<size_t, size_t> split{0, 0};
+        std::vector<uint32_t> route;
+        for (size_t p = 0; p < t.size(); p++) {
+          route.push_back(t[p]);
+          if (p + 1 < t.size() && !((mask >> p) & 1)) continue;
+          const size_t length = TSP::routeLength(cities, depot, route);
+          split = {split.first + length, std::max(split.second, length)};
+          route.clear();
+        }
+        splits.push_back(split);
+      }
+
+      // A limit from just below the tightest split's longest route (so none fits) to a little above it
+      size_t tightest = SIZE_MAX;
+      for (const auto& split : splits) tightest = std::min(tightest, split.second);
+      for (const size_t& limit : {SIZE_MAX, std::max<size_t>(tightest, 1) - 1 + rng() % 5}) {
+        size_t expected = SIZE_MAX;
+        for (const auto& split : splits) if (split.second <= limit) expected = std::min(expected, split.first);
+        size_t found = SIZE_MAX;
+        try {
+          found = TSP::splitTour(cities, tour, depot, vehicles, limit).total;
+        } catch (const std::runtime_error&) {}
+        if (limit != SIZE_MAX) limited++;
+        if (found == expected) continue;
+        if (failures++ < 10) {
+          std::printf("  instance %zu (n = %zu, m = %zu, limit %zu): split %zu, exhaustive %zu\n", s, n, m, limit,
+                      found, expected);
+        }
+      }
+    }
+    std::printf("splitTour: %zu of %zu splits (%zu limited) match an exhaustive search\n", 2 * instances - failures,
+                2 * instances, limited);
+    return failures;
+  }
+
+  /**
+   * Times the stream parser of `constructCities` against `parseCities` at one & all threads, on the given
+   * file and on a generated one-million-city file held in memory.
+   */
+  void benchParsing(const std::string& filename) {
+    std::printf("parsing\n");
+    if (!filename.empty()) {
+      Clock::time_point streamed = Clock::now();
+      const size_t count = TSP::constructCities(filename).size();
+      std::printf("  %-24s %8.3f s   (%zu cities)\n", "constructCities", secondsSince(streamed), count);
+      Clock::time_point read = Clock::now();
+      TSP::readCities(filename);
+      std::printf("  %-24s %8.3f s\n", "readCities", secondsSince(read));
+    }
+
+    const std::string text = generatedFile(1000000, 3);
+    for (const size_t& threads : {size_t(1), Parallel::defaultThreads()}) {
+      Clock::time_point parsed = Clock::now();
+      const size_t count = TSP::parseCities(text, threads).size();
+      std::printf("  parseCities, %2zu threads  %8.3f s   (%zu cities)\n", threads, secondsSince(parsed), count);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  // bench [--kernels=LEVEL] [file], with --train or --throughput before the file for the PGO workloads & --verify-nn
+  // before it to check nearest neighbor tours; --verify-split checks splitTour on generated instances
+  std::vector<std::string> args(argv + 1, argv + argc);
+  const std::string KERNELS = "--kernels=";
+  const bool forced = !args.empty() && args[0].rfind(KERNELS, 0) == 0;
+  try {
+    // Without --kernels, a bad TSP_KERNELS is reported here rather than by the first kernel call
+    if (forced) Kernels::setLevel(Kernels::parseLevel(args[0].substr(KERNELS.size())));
+    else Kernels::activeLevel();
+  } catch (const std::runtime_error& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  if (forced) args.erase(args.begin());
+  const std::string mode = !args.empty() && args[0].rfind("--", 0) == 0 ? args[0] : "";
+  const size_t first = mode.empty() ? 0 : 1;
+  const std::string filename = args.size() > first ? args[first] : "ja9847.tsp";
+  if (mode == "--train") {
+    train(filename);
+    return 0;
+  }
+  if (mode == "--throughput") {
+    benchThroughput(filename);
+    return 0;
+  }
+  if (mode == "--verify-nn") return verifyNearestNeighbor(filename) == 0 ? 0 : 1;
+  if (mode == "--verify-split") return verifySplit(10000) == 0 ? 0 : 1;
+  if (!mode.empty()) {
+    std::cerr << "Unknown option " << mode << "; use --kernels=LEVEL, --train, --throughput, --verify-nn or "
+              << "--verify-split." << std::endl;
+    return 1;
+  }
+  std::list<Node> nodes = TSP::constructCities(filename);
+  const std::list<Node> clustered = clusteredCities(20000, 40, 1);
+  if (!nodes.empty()) benchCandidates(filename, nodes, 8);
+  benchCandidates("clustered", clustered, 8);
+  if (!nodes.empty()) benchMultilevel(filename, nodes);
+  benchMultilevel("clustered", clustered);
+  if (!nodes.empty()) benchRouting(filename, nodes, 50);
+  benchParsing(nodes.empty() ? "" : filename);
+  benchPool(nodes);
+  benchKernels(nodes.empty() ? clustered : nodes);
+  return 0;
+}
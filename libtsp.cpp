@@ -0,0 +1,218 @@
+#include "libtsp.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+
+#include "Candidates.hpp"
+#include "CitySet.hpp"
+#include "LocalSearch.hpp"
+#include "Multilevel.hpp"
+#include "TSP.hpp"
+
+struct tsp_instance {
+  TSP::CitySet cities;
+  std::vector<uint32_t> tour;
+  uint64_t length = 0;
+  bool solved = false;
+};
+
+namespace {
+  thread_local std::string last_error;
+
+  tsp_status fail(const tsp_status& status, const std::string& message) {
+    last_error = message;
+    return status;
+  }
+
+  // Runs `body`, turning any exception into TSP_FAILED so none crosses the C boundary
+  template <typename Body>
+  tsp_status guarded(const Body& body) {
+    try {
+      last_error.clear();
+      return body();
+    } catch (const std::exception& e) {
+      return fail(TSP_FAILED, e.what());
+    } catch (...) {
+      return fail(TSP_FAILED, "Unknown error.");
+    }
+  }
+}
+
+/**
+ * @return TSP_ABI_VERSION of the library.
+ */
+uint32_t tsp_abi_version(void) {
+  return TSP_ABI_VERSION;
+}
+
+/**
+ * Fills a configuration with the defaults.
+ *
+ * @param config The configuration to fill; null is ignored.
+ */
+void tsp_config_init(tsp_config* config) {
+  if (!config) return;
+  config->size = sizeof(tsp_config);
+  config->solver = TSP_SOLVER_MULTILEVEL;
+  config->threads = 0;
+  config->candidates = 8;
+  config->coarsest = 1000;
+  config->start = 0;
+}
+
+/**
+ * Creates an instance, copying the coordinates once into a `DOUBLE` city set with ids 1..n.
+ *
+ * @param xs The x-coordinate of every city, by index.
+ * @param ys The y-coordinate of every city, by index.
+ * @param n The number of cities.
+ * @param instance Receives the new instance.
+ * @return TSP_INVALID_ARGUMENT for null arrays (with n > 0) or a null `instance`, TSP_FAILED if memory runs
+ *         out.
+ */
+tsp_status tsp_create(const double* xs, const double* ys, size_t n, tsp_instance** instance) {
+  return tsp_create_strided(xs, ys, n, sizeof(double), instance);
+}
+
+/**
+ * Creates an instance from coordinates a fixed number of bytes apart, gathering them once into the city
+ * set's arrays.
+ *
+ * @param xs The x-coordinate of the first city.
+ * @param ys The y-coordinate of the first city.
+ * @param n The number of cities.
+ * @param stride The number of bytes between consecutive cities' coordinates.
+ * @param instance Receives the new instance.
+ * @return TSP_INVALID_ARGUMENT for null arrays (with n > 0), a null `instance` or a stride that is not a
+ *         positive multiple of sizeof(double), TSP_FAILED if memory runs out.
+ */
+tsp_status tsp_create_strided(const double* xs, const double* ys, size_t n, size_t stride,
+                              tsp_instance** instance) {
+  if (!instance || (n > 0 && (!xs || !ys))) return fail(TSP_INVALID_ARGUMENT, "tsp_create needs coordinates.");
+  if (stride == 0 || stride % sizeof(double) != 0) {
+    return fail(TSP_INVALID_ARGUMENT, "The stride must be a positive multiple of sizeof(double).");
+  }
+  if (n > UINT32_MAX) return fail(TSP_INVALID_ARGUMENT, "Too many cities.");
+  *instance = nullptr;
+  return guarded([&]() {
+    const size_t step = stride / sizeof(double);
+    auto created = std::make_unique<tsp_instance>();
+    TSP::CitySet& cities = created->cities;
+    cities.xs.resize(n);
+    cities.ys.resize(n);
+    cities.ids.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      cities.xs[i] = xs[i * step];
+      cities.ys[i] = ys[i * step];
+      cities.ids[i] = i + 1;
+    }
+    cities.indexIds();
+    *instance = created.release();
+    return TSP_OK;
+  });
+}
+
+/**
+ * Frees an instance.
+ *
+ * @param instance The instance; null is ignored.
+ */
+void tsp_destroy(tsp_instance* instance) {
+  delete instance;
+}
+
+/**
+ * @param instance The instance.
+ * @return The number of cities, or 0 for null.
+ */
+size_t tsp_size(const tsp_instance* instance) {
+  return instance ? instance->cities.size() : 0;
+}
+
+/**
+ * Builds a tour of every city with the configured solver & rotates it to start at `config->start`.
+ *
+ * @param instance The instance to solve.
+ * @param config The settings; null for the defaults. Only the first `config->size` bytes are read.
+ * @return TSP_INVALID_ARGUMENT for a null instance, an undersized config, a start out of range or an unknown
+ *         solver, TSP_FAILED if the solver throws.
+ */
+tsp_status tsp_solve(tsp_instance* instance, const tsp_config* config) {
+  if (!instance) return fail(TSP_INVALID_ARGUMENT, "tsp_solve needs an instance.");
+  tsp_config settings;
+  tsp_config_init(&settings);
+  if (config) {
+    if (config->size < sizeof(size_t)) return fail(TSP_INVALID_ARGUMENT, "tsp_config.size is not set.");
+    const size_t size = std::min(config->size, sizeof(tsp_config));
+    std::copy(reinterpret_cast<const char*>(config) + sizeof(size_t), reinterpret_cast<const char*>(config) + size,
+              reinterpret_cast<char*>(&settings) + sizeof(size_t));
+  }
+  const TSP::CitySet& cities = instance->cities;
+  const size_t n = cities.size();
+  if (n > 0 && settings.start >= n) return fail(TSP_INVALID_ARGUMENT, "The start city is out of range.");
+  const int solver = settings.solver;
+  if (solver < TSP_SOLVER_MULTILEVEL || solver > TSP_SOLVER_NEAREST_NEIGHBOR) {
+    return fail(TSP_INVALID_ARGUMENT, "Unknown solver.");
+  }
+  const size_t threads = settings.threads ? settings.threads : Parallel::defaultThreads();
+
+  instance->solved = false;
+  return guarded([&]() {
+    std::vector<uint32_t> order;
+    if (n < 4 || settings.solver == TSP_SOLVER_NEAREST_NEIGHBOR) {
+      order = TSP::nearestNeighbor(cities, settings.start);
+    } else if (settings.solver == TSP_SOLVER_LOCAL_SEARCH) {
+      const size_t k = std::max<size_t>(1, std::min(settings.candidates, n - 1));
+      order = TSP::localSearch(cities, TSP::nearestCandidates(cities, k, threads),
+                               TSP::nearestNeighbor(cities, settings.start));
+    } else {
+      order = TSP::multilevel(cities, std::max<size_t>(settings.coarsest, 3), threads);
+    }
+    if (n > 0) std::rotate(order.begin(), std::find(order.begin(), order.end(), settings.start), order.end());
+
+    uint64_t length = 0;
+    for (size_t i = 0; i < n; i++) length += cities.distance(order[i], order[(i + 1) % n]);
+    instance->tour = std::move(order);
+    instance->length = length;
+    instance->solved = true;
+    return TSP_OK;
+  });
+}
+
+/**
+ * Copies the last tour into a caller buffer.
+ *
+ * @param instance The solved instance.
+ * @param buffer Receives the tour.
+ * @param capacity The number of indices `buffer` holds.
+ * @param written Receives the number of indices in the tour; may be null.
+ * @return TSP_BUFFER_TOO_SMALL if `capacity` is below the tour size, in which case nothing is copied;
+ *         TSP_NOT_SOLVED if there is no tour.
+ */
+tsp_status tsp_tour(const tsp_instance* instance, uint32_t* buffer, size_t capacity, size_t* written) {
+  if (!instance) return fail(TSP_INVALID_ARGUMENT, "tsp_tour needs an instance.");
+  if (!instance->solved) return fail(TSP_NOT_SOLVED, "The instance has not been solved.");
+  const std::vector<uint32_t>& tour = instance->tour;
+  if (written) *written = tour.size();
+  if (capacity < tour.size()) return fail(TSP_BUFFER_TOO_SMALL, "The buffer cannot hold the tour.");
+  if (!tour.empty() && !buffer) return fail(TSP_INVALID_ARGUMENT, "tsp_tour needs a buffer.");
+  std::copy(tour.begin(), tour.end(), buffer);
+  return TSP_OK;
+}
+
+/**
+ * @param instance The instance.
+ * @return The length of the last tour, or 0 if there is none.
+ */
+uint64_t tsp_tour_length(const tsp_instance* instance) {
+  return instance && instance->solved ? instance->length : 0;
+}
+
+/**
+ * @return The message of the last failure on the calling thread.
+ */
+const char* tsp_last_error(void) {
+  return last_error.c_str();
+}
@@ -0,0 +1,114 @@
+#pragma once
+/*
+ * C interface to the solver, for embedding it in other programs through libtsp.a or libtsp.so. Only the
+ * functions below are exported; the C++ types behind `tsp_instance` may change between releases, while
+ * this interface only grows in ways that keep TSP_ABI_VERSION.
+ *
+ * Every function that can fail returns a `tsp_status`; `tsp_last_error` then describes the failure. No
+ * function throws or aborts. Distinct instances may be used from different threads at once; one instance
+ * must not be.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define TSP_API __attribute__((visibility("default")))
+#else
+#define TSP_API
+#endif
+
+#define TSP_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tsp_instance tsp_instance;
+
+typedef enum tsp_status {
+  TSP_OK = 0,
+  TSP_INVALID_ARGUMENT = 1, /* a null pointer, a city index out of range, or an unknown solver */
+  TSP_BUFFER_TOO_SMALL = 2, /* the tour does not fit; `tsp_tour` reports the size it needs */
+  TSP_NOT_SOLVED = 3,       /* no tour yet: `tsp_solve` has not succeeded on the instance */
+  TSP_FAILED = 4            /* the solver failed, e.g. out of memory */
+} tsp_status;
+
+typedef enum tsp_solver {
+  TSP_SOLVER_MULTILEVEL = 0,      /* coarsen, solve the coarsest level & refine with local search */
+  TSP_SOLVER_LOCAL_SEARCH = 1,    /* nearest neighbor, then local search over nearest candidates */
+  TSP_SOLVER_NEAREST_NEIGHBOR = 2 /* nearest neighbor only */
+} tsp_solver;
+
+/*
+ * Solver settings. Fill with `tsp_config_init` before changing fields, so fields added by later versions
+ * keep their defaults; `size` tells the library which version of the struct the caller was built with.
+ */
+typedef struct tsp_config {
+  size_t size;       /* sizeof(tsp_config), set by `tsp_config_init` */
+  tsp_solver solver; /* default TSP_SOLVER_MULTILEVEL */
+  size_t threads;    /* threads to use; 0 (default) for one per hardware thread */
+  size_t candidates; /* candidate neighbors per city for local search; default 8 */
+  size_t coarsest;   /* multilevel coarsening stops at this many cities; default 1000 */
+  uint32_t start;    /* index of the city the tour starts at; default 0 */
+} tsp_config;
+
+/* @return TSP_ABI_VERSION of the library, to compare with the header the caller was built with. */
+TSP_API uint32_t tsp_abi_version(void);
+
+/* Fills `config` with the defaults. */
+TSP_API void tsp_config_init(tsp_config* config);
+
+/*
+ * Creates an instance over n cities with Euclidean distances rounded to the nearest integer, as for TSPLIB
+ * EUC_2D. The coordinates are read once, straight into the solver's own arrays; the caller's arrays may be
+ * freed as soon as this returns.
+ *
+ * @param xs The x-coordinate of every city, by index.
+ * @param ys The y-coordinate of every city, by index.
+ * @param n The number of cities.
+ * @param instance Receives the new instance, to be freed with `tsp_destroy`.
+ */
+TSP_API tsp_status tsp_create(const double* xs, const double* ys, size_t n, tsp_instance** instance);
+
+/*
+ * Creates an instance like `tsp_create` from coordinates `stride` bytes apart, e.g. interleaved (x, y) pairs
+ * with ys = xs + 1 & stride = 2 * sizeof(double).
+ *
+ * @param stride The number of bytes from one city's coordinate to the next city's; a multiple of
+ *               sizeof(double).
+ */
+TSP_API tsp_status tsp_create_strided(const double* xs, const double* ys, size_t n, size_t stride,
+                                      tsp_instance** instance);
+
+/* Frees an instance; null is ignored. */
+TSP_API void tsp_destroy(tsp_instance* instance);
+
+/* @return The number of cities of an instance, or 0 for null. */
+TSP_API size_t tsp_size(const tsp_instance* instance);
+
+/*
+ * Builds a tour of every city, replacing any earlier one.
+ *
+ * @param config The settings; null for the defaults.
+ */
+TSP_API tsp_status tsp_solve(tsp_instance* instance, const tsp_config* config);
+
+/*
+ * Copies the last tour into a caller buffer: every city index once, in visiting order, starting with the
+ * configured start city.
+ *
+ * @param buffer Receives the tour; may be null when `capacity` is 0, to ask for the size.
+ * @param capacity The number of indices `buffer` holds.
+ * @param written Receives the number of indices in the tour, even when they do not fit; may be null.
+ */
+TSP_API tsp_status tsp_tour(const tsp_instance* instance, uint32_t* buffer, size_t capacity, size_t* written);
+
+/* @return The length of the last tour, including the edge back to the start, or 0 if there is none. */
+TSP_API uint64_t tsp_tour_length(const tsp_instance* instance);
+
+/* @return A description of the last failure on the calling thread; empty if there was none. */
+TSP_API const char* tsp_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
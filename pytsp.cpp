@@ -0,0 +1,220 @@
+// Python extension `pytsp` over the C interface of libtsp.h, built with `make python`. It uses only the
+// CPython API & the buffer protocol, so it builds offline against the interpreter's own headers & reads
+// NumPy arrays, memoryviews & other buffers alike.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+
+#include "libtsp.h"
+
+namespace {
+  // A `tsp_instance` owned by a Python object; `busy` is set while a solve runs without the GIL
+  struct CitySetObject {
+    PyObject_HEAD
+    tsp_instance* instance;
+    bool busy;
+  };
+
+  // Raises the Python exception matching a failed status
+  PyObject* raise(const tsp_status& status) {
+    PyObject* type = status == TSP_INVALID_ARGUMENT ? PyExc_ValueError : PyExc_RuntimeError;
+    PyErr_SetString(type, tsp_last_error());
+    return nullptr;
+  }
+
+  // Whether a buffer format describes a native double: "d", or NumPy's "<d" on little-endian hosts
+  bool isDouble(const char* format) {
+    if (!format) return false;
+    if (format[0] == '@' || format[0] == '=' || (format[0] == '<' && PY_LITTLE_ENDIAN)) format++;
+    return std::strcmp(format, "d") == 0;
+  }
+
+  void citySetDealloc(CitySetObject* self) {
+    tsp_destroy(self->instance);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+  }
+
+  /**
+   * CitySet(coordinates): reads an (n, 2) float64 buffer in place, e.g. a NumPy array of any row & column
+   * strides that are whole doubles, gathering x & y once into the solver's arrays.
+   */
+  int citySetInit(CitySetObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"coordinates", nullptr};
+    PyObject* coordinates = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char**>(keywords), &coordinates)) return -1;
+    if (self->busy) {
+      PyErr_SetString(PyExc_RuntimeError, "CitySet is being solved by another thread.");
+      return -1;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(coordinates, &view, PyBUF_STRIDES | PyBUF_FORMAT) != 0) return -1;
+    const char* problem = nullptr;
+    if (view.ndim != 2 || view.shape[1] != 2) problem = "coordinates must have shape (n, 2).";
+    else if (!isDouble(view.format) || view.itemsize != sizeof(double)) problem = "coordinates must be float64.";
+    else if (view.strides[0] <= 0 || view.strides[1] <= 0 || view.strides[0] % sizeof(double) != 0 ||
+             view.strides[1] % sizeof(double) != 0) {
+      problem = "coordinates need positive strides of whole doubles; use numpy.ascontiguousarray.";
+    }
+    if (problem) {
+      PyBuffer_Release(&view);
+      PyErr_SetString(PyExc_ValueError, problem);
+      return -1;
+    }
+
+    const double* xs = static_cast<const double*>(view.buf);
+    const double* ys = reinterpret_cast<const double*>(static_cast<const char*>(view.buf) + view.strides[1]);
+    tsp_instance* instance = nullptr;
+    const tsp_status status = tsp_create_strided(xs, ys, size_t(view.shape[0]), size_t(view.strides[0]), &instance);
+    PyBuffer_Release(&view);
+    if (status != TSP_OK) {
+      raise(status);
+      return -1;
+    }
+    tsp_destroy(self->instance);
+    self->instance = instance;
+    return 0;
+  }
+
+  Py_ssize_t citySetLength(CitySetObject* self) {
+    return Py_ssize_t(tsp_size(self->instance));
+  }
+
+  /**
+   * CitySet.solve(solver="multilevel", threads=0, candidates=8, coarsest=1000, start=0): builds a tour with
+   * the GIL released & returns it as a NumPy uint32 array (an array.array("I") if NumPy is not installed),
+   * written by `tsp_tour` straight into the array's buffer.
+   */
+  PyObject* citySetSolve(CitySetObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"solver", "threads", "candidates", "coarsest", "start", nullptr};
+    const char* solver = "multilevel";
+    tsp_config config;
+    tsp_config_init(&config);
+    Py_ssize_t threads = 0, candidates = Py_ssize_t(config.candidates), coarsest = Py_ssize_t(config.coarsest);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|snnnI", const_cast<char**>(keywords), &solver, &threads,
+                                     &candidates, &coarsest, &config.start)) {
+      return nullptr;
+    }
+    if (threads < 0 || candidates < 0 || coarsest < 0) {
+      PyErr_SetString(PyExc_ValueError, "threads, candidates & coarsest must not be negative.");
+      return nullptr;
+    }
+    config.threads = size_t(threads);
+    config.candidates = size_t(candidates);
+    config.coarsest = size_t(coarsest);
+    if (std::strcmp(solver, "multilevel") == 0) config.solver = TSP_SOLVER_MULTILEVEL;
+    else if (std::strcmp(solver, "local_search") == 0) config.solver = TSP_SOLVER_LOCAL_SEARCH;
+    else if (std::strcmp(solver, "nearest_neighbor") == 0) config.solver = TSP_SOLVER_NEAREST_NEIGHBOR;
+    else {
+      PyErr_SetString(PyExc_ValueError, "solver must be multilevel, local_search or nearest_neighbor.");
+      return nullptr;
+    }
+    if (!self->instance) {
+      PyErr_SetString(PyExc_RuntimeError, "CitySet was not initialized.");
+      return nullptr;
+    }
+    if (self->busy) {
+      PyErr_SetString(PyExc_RuntimeError, "CitySet is being solved by another thread.");
+      return nullptr;
+    }
+
+    self->busy = true;
+    tsp_status status;
+    Py_BEGIN_ALLOW_THREADS
+    status = tsp_solve(self->instance, &config);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    if (status != TSP_OK) return raise(status);
+
+    const size_t n = tsp_size(self->instance);
+    PyObject* tour = nullptr;
+    if (PyObject* numpy = PyImport_ImportModule("numpy")) {
+      tour = PyObject_CallMethod(numpy, "empty", "(ns)", Py_ssize_t(n), "uint32");
+      Py_DECREF(numpy);
+    } else {
+      PyErr_Clear();
+      PyObject* array = PyImport_ImportModule("array");
+      if (!array) return nullptr;
+      PyObject* zeros = PyBytes_FromStringAndSize(nullptr, Py_ssize_t(n * sizeof(uint32_t)));
+      if (zeros) {
+        std::memset(PyBytes_AS_STRING(zeros), 0, n * sizeof(uint32_t));
+        tour = PyObject_CallMethod(array, "array", "(sO)", "I", zeros);
+        Py_DECREF(zeros);
+      }
+      Py_DECREF(array);
+    }
+    if (!tour) return nullptr;
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(tour, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) != 0) {
+      Py_DECREF(tour);
+      return nullptr;
+    }
+    if (size_t(view.len) != n * sizeof(uint32_t)) {
+      PyBuffer_Release(&view);
+      Py_DECREF(tour);
+      PyErr_SetString(PyExc_RuntimeError, "The tour array does not hold 32-bit indices.");
+      return nullptr;
+    }
+    status = tsp_tour(self->instance, static_cast<uint32_t*>(view.buf), n, nullptr);
+    PyBuffer_Release(&view);
+    if (status != TSP_OK) {
+      Py_DECREF(tour);
+      return raise(status);
+    }
+    return tour;
+  }
+
+  /**
+   * CitySet.tour_length(): the length of the last tour, closing edge included; 0 before the first solve.
+   */
+  PyObject* citySetTourLength(CitySetObject* self, PyObject*) {
+    if (self->busy) {
+      PyErr_SetString(PyExc_RuntimeError, "CitySet is being solved by another thread.");
+      return nullptr;
+    }
+    return PyLong_FromUnsignedLongLong(tsp_tour_length(self->instance));
+  }
+
+  PyMethodDef citySetMethods[] = {
+    {"solve", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(citySetSolve)),
+     METH_VARARGS | METH_KEYWORDS,
+     "solve(solver='multilevel', threads=0, candidates=8, coarsest=1000, start=0)\n\n"
+     "Builds a tour of every city, with the GIL released, & returns its city indices from `start`."},
+    {"tour_length", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(citySetTourLength)),
+     METH_NOARGS, "The length of the last tour, including the edge back to the start."},
+    {nullptr, nullptr, 0, nullptr}
+  };
+
+  PySequenceMethods citySetSequence = {};
+  PyTypeObject citySetType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+  PyModuleDef module = {PyModuleDef_HEAD_INIT};
+}
+
+PyMODINIT_FUNC PyInit_pytsp(void) {
+  citySetSequence.sq_length = reinterpret_cast<lenfunc>(citySetLength);
+  citySetType.tp_name = "pytsp.CitySet";
+  citySetType.tp_basicsize = sizeof(CitySetObject);
+  citySetType.tp_flags = Py_TPFLAGS_DEFAULT;
+  citySetType.tp_doc = "CitySet(coordinates)\n\nCities read from an (n, 2) float64 array, e.g. a NumPy array.";
+  citySetType.tp_new = PyType_GenericNew;
+  citySetType.tp_init = reinterpret_cast<initproc>(citySetInit);
+  citySetType.tp_dealloc = reinterpret_cast<destructor>(citySetDealloc);
+  citySetType.tp_methods = citySetMethods;
+  citySetType.tp_as_sequence = &citySetSequence;
+  if (PyType_Ready(&citySetType) < 0) return nullptr;
+
+  module.m_name = "pytsp";
+  module.m_doc = "Euclidean TSP solver over NumPy coordinate arrays.";
+  module.m_size = -1;
+  PyObject* created = PyModule_Create(&module);
+  if (!created) return nullptr;
+  Py_INCREF(&citySetType);
+  if (PyModule_AddObject(created, "CitySet", reinterpret_cast<PyObject*>(&citySetType)) < 0) {
+    Py_DECREF(&citySetType);
+    Py_DECREF(created);
+    return nullptr;
+  }
+  return created;
+}